@@ -180,6 +180,7 @@ namespace ezi
                 {
                     auto& win = Private::GetWindowById(std::to_string(reinterpret_cast<uint64_t>(tray.eventReceiver)));
                     win.ExecuteScript("window.__TrayMenuItemClickCallback_(" + std::to_string(eventId) + ");");
+                    Bridge::GetInstance().Emit("tray.menuItemClicked", { { "id", eventId } }, win.GetWinId());
                 }
                 catch(...)
                 {
@@ -291,14 +292,11 @@ namespace ezi
 
     namespace tray
     {
-        Object show(Object args)
+        void show(const CallContext& context, Window& window)
         {
-            auto& window       = Private::GetWindowById(args["mainWindowId"]);
-            auto& senderWindow = Private::GetWindowById(args["senderWinId"]);
-            auto& tray         = Tray::GetInstance();
-            tray.SetEventReceiver(senderWindow.GetWinId());
+            auto& tray = Tray::GetInstance();
+            tray.SetEventReceiver(context.sender);
             tray.Show(window.GetWinId());
-            return "success";
         }
 
         Object hide(Object args)
@@ -321,7 +319,7 @@ namespace ezi
         {
             Tray::GetInstance();
 
-            REG(tray, show);
+            REG_ARGS(tray, show, "mainWindowId");
             REG(tray, hide);
             REG(tray, setContextMenu);
         }
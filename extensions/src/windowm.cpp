@@ -19,7 +19,7 @@ namespace ezi
     // 窗口管理器
     namespace windowm
     {
-        Object getWindowList(Object args)
+        Object getWindowList()
         {
             Array       result;
             WindowList& windows = Application::GetInstance().GetWindowList();
@@ -34,10 +34,10 @@ namespace ezi
             return result;
         }
 
-        Object createWindow(Object args)
+        Object createWindow(const Object& options)
         {
             Object result;
-            auto&  window = Application::GetInstance().CrtWindowByOption(args["options"]);
+            auto&  window = Application::GetInstance().CrtWindowByOption(options);
 
             result["id"]    = std::to_string(reinterpret_cast<uintptr_t>(window.GetWinId()));
             result["title"] = window.GetTitle();
@@ -45,10 +45,10 @@ namespace ezi
             return result;
         }
 
-        Object getCurrentWindow(Object args)
+        Object getCurrentWindow(const CallContext& context)
         {
             Object result;
-            auto   window   = Private::GetWindowById(args["senderWinId"]);
+            auto&  window   = Application::GetInstance().GetWindowById(context.sender);
             result["id"]    = std::to_string(reinterpret_cast<uintptr_t>(window.GetWinId()));
             result["title"] = window.GetTitle();
             return result;
@@ -59,111 +59,86 @@ namespace ezi
     // 窗口的对应操作
     namespace windowm
     {
-        Object show(Object args)
+        void show(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Show();
-            return "success";
         }
 
-        Object maximize(Object args)
+        void maximize(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Maximize();
-            return "success";
         }
 
-        Object minimize(Object args)
+        void minimize(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Minimize();
-            return "success";
         }
 
-        Object restore(Object args)
+        void restore(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Restore();
-            return "success";
         }
 
-        Object close(Object args)
+        void close(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Close();
-            return "success";
         }
 
-        Object reload(Object args)
+        void reload(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Reload();
-            return "success";
         }
 
-        Object focus(Object args)
+        void focus(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Focus();
-            return "success";
         }
 
-        Object blur(Object args)
+        void blur(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Blur();
-            return "success";
         }
 
-        Object hide(Object args)
+        void hide(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Hide();
-            return "success";
         }
 
-        Object drag(Object args)
+        void drag(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             window.Drag();
-            return "success";
         }
 
-        Object isMaximizable(Object args)
+        bool isMaximizable(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsMaximizable();
         }
 
-        Object isMaximized(Object args)
+        bool isMaximized(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsMaximized();
         }
 
-        Object isMinimizable(Object args)
+        bool isMinimizable(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsMinimizable();
         }
 
-        Object isMinimized(Object args)
+        bool isMinimized(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsMinimized();
         }
 
-        Object isMovable(Object args)
+        bool isMovable(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsMovable();
         }
 
-        Object isClosed(Object args)
+        bool isClosed(const String& winId)
         {
             try
             {
-                Private::GetWindowById(args["winId"]);
+                Private::GetWindowById(winId);
                 return false;
             }
             catch(...)
@@ -172,33 +147,28 @@ namespace ezi
             }
         }
 
-        Object isFocusable(Object args)
+        bool isFocusable(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsFocusable();
         }
 
-        Object isFocused(Object args)
+        bool isFocused(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsFocused();
         }
 
-        Object isVisible(Object args)
+        bool isVisible(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsVisible();
         }
 
-        Object isBorderless(Object args)
+        bool isBorderless(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             return window.IsBorderless();
         }
 
-        Object getBackgroundMode(Object args)
+        String getBackgroundMode(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
             switch(window.GetBackgroundMode())
             {
             case BackgroundMode::opaque:
@@ -214,39 +184,32 @@ namespace ezi
             }
         }
 
-        Object getSize(Object args)
+        Object getSize(Window& window)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            Size  size   = window.GetSize();
+            Size size = window.GetSize();
             return Object {
                 { "width", size.width },
                 { "height", size.height },
             };
         }
 
-        Object getPosition(Object args)
+        Object getPosition(Window& window)
         {
-            auto&    window = Private::GetWindowById(args["winId"]);
-            Position pos    = window.GetPosition();
+            Position pos = window.GetPosition();
             return Object {
                 { "x", pos.x },
                 { "y", pos.y },
             };
         }
 
-        Object setTitle(Object args)
+        void setTitle(Window& window, const String& title)
         {
-            auto&  window = Private::GetWindowById(args["winId"]);
-            String title  = args["title"];
             window.SetTitle(title);
-            return "success";
         }
 
-        Object setBackgroundMode(Object args)
+        void setBackgroundMode(Window& window, const String& modeStr)
         {
-            auto&          window = Private::GetWindowById(args["winId"]);
             BackgroundMode mode;
-            String         modeStr = args["mode"];
             if(modeStr == "opaque")
             {
                 mode = BackgroundMode::opaque;
@@ -268,84 +231,58 @@ namespace ezi
                 mode = BackgroundMode::opaque;
             }
             window.SetBackgroundMode(mode);
-            return "success";
         }
 
-        Object setSize(Object args)
+        void setSize(Window& window, int width, int height)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            Size  size;
-            size.width  = args["width"];
-            size.height = args["height"];
-            window.SetSize(size);
-            return "success";
+            window.SetSize({ width, height });
         }
 
-        Object setPosition(Object args)
+        void setPosition(Window& window, int x, int y)
         {
-            auto&    window = Private::GetWindowById(args["winId"]);
-            Position pos;
-            pos.x = args["x"];
-            pos.y = args["y"];
-            window.SetPosition(pos);
-            return "success";
+            window.SetPosition({ x, y });
         }
 
-        Object setMaximizable(Object args)
+        void setMaximizable(Window& window, bool enable)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            bool  enable = args["enable"];
             window.SetMaximizable(enable);
-            return "success";
         }
 
-        Object setMinimizable(Object args)
+        void setMinimizable(Window& window, bool enable)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            bool  enable = args["enable"];
             window.SetMinimizable(enable);
-            return "success";
         }
 
-        Object setMovable(Object args)
+        void setMovable(Window& window, bool enable)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            bool  enable = args["enable"];
             window.SetMovable(enable);
-            return "success";
         }
 
-        Object setFocusable(Object args)
+        void setFocusable(Window& window, bool enable)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            bool  enable = args["enable"];
             window.SetFocusable(enable);
-            return "success";
         }
 
-        Object setBorderless(Object args)
+        void setBorderless(Window& window, bool enable)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-            bool  enable = args["enable"];
             window.SetBorderless(enable);
-            return "success";
         }
 
-        Object setBeforeCloseMessage(Object args)
+        Object setBeforeCloseMessage(const CallContext& context,
+            Window&                                     window,
+            const std::optional<String>&                _callbackName,
+            const std::optional<Object>&                options)
         {
-            auto& window = Private::GetWindowById(args["winId"]);
-
-            if(!args.contains("callbackName") || !args.contains("options"))
+            if(!_callbackName || !options)
             {
                 window.SetOnCloseCallback(nullptr);
                 return "unkonwn arguments";
             }
-            String callbackName = args["callbackName"];
-            Object options      = args["options"];
-            String content      = options["content"];
-            String extraButton  = options["extraButton"];
+            String callbackName = *_callbackName;
+            String content      = options->at("content");
+            String extraButton  = options->at("extraButton");
 
-            auto& feedbackWindow = Private::GetWindowById(args["senderWinId"]);
+            auto& feedbackWindow = Application::GetInstance().GetWindowById(context.sender);
 
             window.SetOnCloseCallback(
                 [callbackName, content, extraButton, &window, &feedbackWindow]()
@@ -392,45 +329,61 @@ namespace ezi
         void Mount()
         {
             REG(windowm, getWindowList);
-            REG(windowm, createWindow);
+            REG_ARGS(windowm, createWindow, "options");
             REG(windowm, getCurrentWindow);
 
-            REG(windowm, show);
-            REG(windowm, maximize);
-            REG(windowm, minimize);
-            REG(windowm, restore);
-            REG(windowm, close);
-            REG(windowm, reload);
-            REG(windowm, focus);
-            REG(windowm, blur);
-            REG(windowm, hide);
-            REG(windowm, drag);
-
-            REG(windowm, isMaximizable);
-            REG(windowm, isMaximized);
-            REG(windowm, isMinimizable);
-            REG(windowm, isMinimized);
-            REG(windowm, isMovable);
-            REG(windowm, isClosed);
-            REG(windowm, isFocusable);
-            REG(windowm, isFocused);
-            REG(windowm, isVisible);
-            REG(windowm, isBorderless);
-
-            REG(windowm, getBackgroundMode);
-            REG(windowm, getSize);
-            REG(windowm, getPosition);
-
-            REG(windowm, setTitle);
-            REG(windowm, setBackgroundMode);
-            REG(windowm, setSize);
-            REG(windowm, setPosition);
-            REG(windowm, setMaximizable);
-            REG(windowm, setMinimizable);
-            REG(windowm, setMovable);
-            REG(windowm, setFocusable);
-            REG(windowm, setBorderless);
-            REG(windowm, setBeforeCloseMessage);
+            REG_ARGS(windowm, show, "winId");
+            REG_ARGS(windowm, maximize, "winId");
+            REG_ARGS(windowm, minimize, "winId");
+            REG_ARGS(windowm, restore, "winId");
+            REG_ARGS(windowm, close, "winId");
+            REG_ARGS(windowm, reload, "winId");
+            REG_ARGS(windowm, focus, "winId");
+            REG_ARGS(windowm, blur, "winId");
+            REG_ARGS(windowm, hide, "winId");
+            REG_ARGS(windowm, drag, "winId");
+
+            REG_ARGS(windowm, isMaximizable, "winId");
+            REG_ARGS(windowm, isMaximized, "winId");
+            REG_ARGS(windowm, isMinimizable, "winId");
+            REG_ARGS(windowm, isMinimized, "winId");
+            REG_ARGS(windowm, isMovable, "winId");
+            REG_ARGS(windowm, isClosed, "winId");
+            REG_ARGS(windowm, isFocusable, "winId");
+            REG_ARGS(windowm, isFocused, "winId");
+            REG_ARGS(windowm, isVisible, "winId");
+            REG_ARGS(windowm, isBorderless, "winId");
+
+            REG_ARGS(windowm, getBackgroundMode, "winId");
+            REG_ARGS(windowm, getSize, "winId");
+            REG_ARGS(windowm, getPosition, "winId");
+
+            REG_ARGS(windowm, setTitle, "winId", "title");
+            REG_ARGS(windowm, setBackgroundMode, "winId", "mode");
+            REG_ARGS(windowm, setSize, "winId", "width", "height");
+            REG_ARGS(windowm, setPosition, "winId", "x", "y");
+            REG_ARGS(windowm, setMaximizable, "winId", "enable");
+            REG_ARGS(windowm, setMinimizable, "winId", "enable");
+            REG_ARGS(windowm, setMovable, "winId", "enable");
+            REG_ARGS(windowm, setFocusable, "winId", "enable");
+            REG_ARGS(windowm, setBorderless, "winId", "enable");
+            REG_ARGS(windowm, setBeforeCloseMessage, "winId", "callbackName", "options");
+
+            // 页面轮询频繁的只读查询，窗口状态变化的事件发出前复用结果
+            auto& bridge = Bridge::GetInstance();
+            auto  memo   = [&bridge](const char* name, std::vector<String> topics)
+            {
+                topics.push_back("window.closed");
+                bridge.SetIdempotent(name, std::chrono::milliseconds(500), topics);
+            };
+            memo("windowm.getWindowList", { "window.created", "window.titleChanged" });
+            memo("windowm.isClosed", { "window.created" });
+            memo("windowm.isMaximized", { "window.resized" });
+            memo("windowm.isMinimized", { "window.resized" });
+            memo("windowm.isFocused", { "window.focusChanged" });
+            memo("windowm.isVisible", { "window.visibilityChanged" });
+            memo("windowm.getSize", { "window.resized" });
+            memo("windowm.getPosition", { "window.moved" });
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "json.hpp"
+
+namespace ezi
+{
+    // 解压后的资源，多处共享同一份数据
+    typedef std::shared_ptr<const std::vector<uint8_t>> AssetBuffer;
+
+    // 解压资源的LRU缓存，按字节数限制总量
+    // 被淘汰的资源若仍被持有，数据在最后一个持有者释放时回收；超过总量的单个资源不缓存
+    class AssetCache
+    {
+    private:
+        struct Entry
+        {
+            String      uri;
+            AssetBuffer buffer;
+        };
+
+        typedef std::list<Entry> EntryList;
+
+        std::mutex                                      mutex;
+        EntryList                                       entries;
+        std::unordered_map<String, EntryList::iterator> index;
+        size_t                                          budget = 32 << 20;
+        size_t                                          used   = 0;
+
+        uint64_t hits      = 0;
+        uint64_t misses    = 0;
+        uint64_t evictions = 0;
+
+    private:
+        void Evict(size_t target);
+
+    public:
+        explicit AssetCache(size_t budget = 32 << 20);
+
+    public:
+        // 命中时移到最近使用的位置，未命中返回空
+        AssetBuffer Get(const String& uri);
+        void        Put(const String& uri, AssetBuffer buffer);
+        void        SetBudget(size_t budget);
+        void        Clear();
+        Json        GetStats();
+    };
+}
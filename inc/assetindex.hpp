@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "assetpack.hpp"
+
+namespace ezi
+{
+    // 资源包的二进制索引
+    // 布局（小端）：头 | 字典表 | 桶表 | 按uri哈希排列的条目表 | 字符串区 | 索引长度u32 | "EZIX"
+    // 各表按结构体的内存布局复制，不转换字节序，只能在小端平台上编译
+    // 桶表以哈希的高bucketBits位为下标，记录该桶在条目表中的起始位置，共 2^bucketBits+1 项
+    // 查找直接在包数据上进行，先定位桶再比较哈希和字符串；加载时不需要解压和解析，也不为条目分配内存
+    class AssetIndex
+    {
+    public:
+        struct Header
+        {
+            char     magic[4];
+            uint32_t version;
+            uint32_t count;
+            uint32_t dictionaryCount;
+            uint32_t bucketBits;
+            uint32_t reserved;
+        };
+
+        // name和uri为字符串区内的偏移
+        struct DictionaryEntry
+        {
+            uint64_t offset;
+            uint64_t size;
+            uint32_t name;
+            uint32_t nameLength;
+        };
+
+        struct Entry
+        {
+            uint64_t hash;
+            uint64_t offset;
+            uint64_t size;
+            uint32_t uri;
+            uint32_t uriLength;
+            int32_t  dictionary;
+            uint32_t flags;
+        };
+
+        static_assert(sizeof(Header) == 24 && sizeof(DictionaryEntry) == 24 && sizeof(Entry) == 40);
+
+        static constexpr char     MAGIC[4]   = { 'E', 'Z', 'I', 'X' };
+        static constexpr uint32_t VERSION    = 1;
+        static constexpr uint32_t SEEKABLE   = 1;
+        static constexpr uint32_t STORED     = 2;
+        static constexpr size_t   FOOTERSIZE = 8;
+
+    private:
+        BinaryData pack;
+        BinaryData dictionaryTable;
+        BinaryData bucketTable;
+        BinaryData entryTable;
+        BinaryData strings;
+        uint32_t   count           = 0;
+        uint32_t   dictionaryCount = 0;
+        uint32_t   bucketBits      = 0;
+
+    private:
+        Entry            GetEntry(size_t index) const;
+        uint64_t         GetHash(size_t index) const;
+        uint32_t         GetBucket(size_t index) const;
+        std::string_view GetString(uint32_t offset, uint32_t length) const;
+        AssetMeta        GetRange(uint64_t offset, uint64_t size) const;
+
+    public:
+        // 64位FNV-1a，写入包中，不能随编译器或平台变化
+        static uint64_t Hash(std::string_view text);
+        // 包末尾是否为二进制索引，否则为旧的json清单
+        static bool Has(BinaryData pack);
+        // 包末尾的索引及其后的长度和魔数，不是二进制索引或长度不对时返回空
+        static BinaryData Locate(BinaryData pack);
+        // entries和dictionaries中的偏移为包内偏移，dictionaries的顺序即条目中的字典序号
+        static std::vector<uint8_t> Build(const std::vector<std::pair<String, AssetMeta>>& entries,
+            const std::vector<std::pair<String, AssetMeta>>&                                dictionaries);
+
+    public:
+        AssetIndex() = default;
+        // 只检查头和各表的边界，条目在查找时才校验
+        explicit AssetIndex(BinaryData pack);
+
+    public:
+        size_t                   GetCount() const;
+        std::string_view         GetUri(size_t index) const;
+        AssetMeta                GetMeta(size_t index) const;
+        std::optional<AssetMeta> Find(std::string_view uri) const;
+
+        size_t           GetDictionaryCount() const;
+        std::string_view GetDictionaryName(size_t index) const;
+        BinaryData       GetDictionary(size_t index) const;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "json.hpp"
+
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
+namespace ezi
+{
+    struct AssetMeta
+    {
+        size_t offset;
+        size_t size;
+        // 压缩时使用的字典序号，-1表示不使用字典
+        int    dictionary = -1;
+        // 分帧存放并带有跳转表，可以按范围读取
+        bool   seekable   = false;
+        // 未压缩，数据就是资源本身，可以直接引用包内的数据
+        bool   stored     = false;
+    };
+
+    // 支持以string_view查找，不必先构造String
+    struct StringHash
+    {
+        typedef void is_transparent;
+
+        size_t operator()(std::string_view text) const
+        {
+            return std::hash<std::string_view>()(text);
+        }
+    };
+
+    typedef std::span<const uint8_t>                                           BinaryData;
+    typedef std::unordered_map<String, AssetMeta, StringHash, std::equal_to<>> AssetMetaMap;
+
+    // zstd解压上下文池
+    // 上下文的创建和销毁需要分配较大的内存，解压时借用，用完归还以便复用
+    class DecompressPool
+    {
+    public:
+        class Lease
+        {
+        private:
+            DecompressPool* pool;
+            ZSTD_DCtx_s*    context;
+
+        public:
+            Lease(DecompressPool* pool, ZSTD_DCtx_s* context);
+            Lease(const Lease&)            = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+            ZSTD_DCtx_s* Get() const;
+        };
+
+    private:
+        std::mutex                mutex;
+        std::vector<ZSTD_DCtx_s*> contexts;
+        size_t                    limit;
+
+    private:
+        DecompressPool(const DecompressPool&)            = delete;
+        DecompressPool& operator=(const DecompressPool&) = delete;
+
+        void Release(ZSTD_DCtx_s* context);
+
+    public:
+        // limit为空闲时保留的上下文数，默认为CPU核数
+        explicit DecompressPool(size_t limit = 0);
+        ~DecompressPool();
+
+    public:
+        Lease Acquire();
+    };
+
+    struct DictionaryDeleter
+    {
+        void operator()(ZSTD_DDict_s* dictionary) const;
+    };
+
+    typedef std::unique_ptr<ZSTD_DDict_s, DictionaryDeleter> Dictionary;
+
+    class AssetStream;
+    class AssetIndex;
+
+    // 资源包
+    // 各资源为独立的zstd帧依次排列，末尾是二进制索引（见 AssetIndex），直接在包数据上查找
+    // 旧的包末尾是zstd压缩的json清单和4字节的清单长度，加载时解析到 AssetMetaMap 中
+    // 清单为 {uri: {offset, size, dict?, seekable?}}；小文件可用训练好的字典压缩，dict为字典名
+    // 字典以原始字节存放在包内，位置记在清单的 "$dictionaries": {name: {offset, size}} 中
+    // 大资源可以存为多个独立帧加跳转表（zstd seekable格式），见 AssetStream
+    // 图片、字体、音视频等已压缩的格式可以不压缩直接存放，只有二进制索引能标记这类资源
+    // 只引用数据而不持有，数据需在资源包的生命周期内有效；构造后只读，可在多个线程同时取用
+    class AssetPack
+    {
+    private:
+        std::shared_ptr<AssetIndex>     index;
+        AssetMetaMap                    metas;
+        BinaryData                      binary;
+        std::vector<Dictionary>         dictionaries;
+        std::shared_ptr<DecompressPool> pool = std::make_shared<DecompressPool>();
+
+    private:
+        void                 LoadManifest();
+        BinaryData           GetRange(const String& name, const Json& range) const;
+        std::vector<uint8_t> Decompress(BinaryData zipData, int dictionary = -1) const;
+
+    public:
+        static constexpr const char* DICTIONARIES = "$dictionaries";
+
+    public:
+        AssetPack() = default;
+        explicit AssetPack(BinaryData binary);
+
+    public:
+        std::optional<AssetMeta> Find(std::string_view uri) const;
+        bool                     Contains(std::string_view uri) const;
+        std::vector<uint8_t>     GetAssetData(std::string_view uri) const;
+        // 资源不存在或不是分帧存放时返回空
+        std::unique_ptr<AssetStream> OpenStream(std::string_view uri) const;
+        // 直接存放的资源在包内的数据，不复制；资源不存在或经过压缩时返回空
+        BinaryData GetStored(std::string_view uri) const;
+    };
+}
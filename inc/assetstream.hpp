@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "assetpack.hpp"
+
+namespace ezi
+{
+    // 可随机读取的资源流
+    // 大资源按固定大小切成独立的zstd帧，末尾附带zstd seekable格式的跳转表
+    // 读取时只解压涉及的帧，任何时候只缓存一帧的解压结果；单个流不能在多个线程同时读取
+    class AssetStream
+    {
+    private:
+        struct Frame
+        {
+            uint64_t compressedOffset;
+            uint32_t compressedSize;
+            uint64_t offset;
+            uint32_t size;
+        };
+
+        BinaryData                      data;
+        std::vector<Frame>              frames;
+        uint64_t                        length   = 0;
+        uint64_t                        position = 0;
+        std::shared_ptr<DecompressPool> pool;
+        std::vector<uint8_t>            buffer;
+        size_t                          buffered = SIZE_MAX;
+
+    private:
+        const std::vector<uint8_t>& LoadFrame(size_t index);
+
+    public:
+        static constexpr uint32_t SKIPPABLEMAGIC = 0x184D2A5E;
+        static constexpr uint32_t SEEKABLEMAGIC  = 0x8F92EAB1;
+        static constexpr size_t   FOOTERSIZE     = 9;
+
+        // 数据末尾是否带有跳转表
+        static bool IsSeekable(BinaryData data);
+
+    public:
+        AssetStream(BinaryData data, std::shared_ptr<DecompressPool> pool);
+
+    public:
+        uint64_t GetLength() const;
+        uint64_t GetPosition() const;
+        void     Seek(uint64_t position);
+        // 返回读取的字节数，到达末尾时返回0
+        size_t   Read(uint8_t* out, size_t size);
+        size_t   ReadAt(uint64_t offset, uint8_t* out, size_t size);
+    };
+
+    // HTTP Range请求的字节范围，end不含
+    struct ByteRange
+    {
+        uint64_t begin = 0;
+        uint64_t end   = 0;
+    };
+
+    enum class RangeResult
+    {
+        // 没有可用的范围，按整个资源返回
+        none,
+        partial,
+        // 范围超出资源长度，应回复416
+        unsatisfiable
+    };
+
+    // 只支持单个范围：bytes=a-b、bytes=a-、bytes=-n；多个范围按整个资源返回
+    RangeResult ParseByteRange(std::string_view header, uint64_t length, ByteRange& range);
+}
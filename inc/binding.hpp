@@ -0,0 +1,180 @@
+#pragma once
+#include "platform.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "json.hpp"
+#include "cancel.hpp"
+#include "envelope.hpp"
+
+namespace ezi
+{
+    class Window;
+
+#if OS(WINDOWS)
+    typedef HWND WinId;
+#else
+    typedef void* WinId;
+#endif
+
+    // 调用上下文，由Bridge随调用传入，不写入参数
+    struct CallContext
+    {
+        WinId             sender = nullptr;
+        CancellationToken token;
+    };
+
+    // 回传给页面的结构化错误
+    class BridgeError : public std::runtime_error
+    {
+    private:
+        String code;
+        String argument;
+
+    public:
+        BridgeError(String code, const String& message, String argument = "")
+            : std::runtime_error(message), code(std::move(code)), argument(std::move(argument))
+        {
+        }
+
+        Json ToJson() const
+        {
+            Json error = {
+                { "error", what() },
+                { "code", code },
+            };
+            if(!argument.empty())
+                error["argument"] = argument;
+            return error;
+        }
+    };
+
+    // 参数解码器，按需特化
+    // 返回引用的解码器直接指向请求中的值，不产生拷贝
+    template <typename T> struct ArgDecoder
+    {
+        static T Decode(const Json& value) { return value.get<T>(); }
+    };
+
+    template <> struct ArgDecoder<Json>
+    {
+        static const Json& Decode(const Json& value) { return value; }
+    };
+
+    template <> struct ArgDecoder<String>
+    {
+        static const String& Decode(const Json& value) { return value.get_ref<const String&>(); }
+    };
+
+    template <typename T> struct ArgDecoder<std::optional<T>>
+    {
+        static std::optional<T> Decode(const Json& value)
+        {
+            if(value.is_null())
+                return std::nullopt;
+            return ArgDecoder<T>::Decode(value);
+        }
+    };
+
+    // 窗口参数为窗口id字符串，在application.cpp中实现
+    template <> struct ArgDecoder<Window>
+    {
+        static Window& Decode(const Json& value);
+    };
+
+    namespace Binding
+    {
+        template <typename T> struct IsOptional : std::false_type
+        {
+        };
+        template <typename T> struct IsOptional<std::optional<T>> : std::true_type
+        {
+        };
+
+        // 上下文参数不占用参数名
+        template <typename T> constexpr bool IsContext = std::is_same_v<std::remove_cvref_t<T>, CallContext>;
+
+        template <typename... Args> constexpr size_t NamedCount = (size_t(0) + ... + (IsContext<Args> ? 0 : 1));
+
+        // 各参数对应的参数名下标
+        template <typename... Args> constexpr std::array<size_t, sizeof...(Args)> NameSlots()
+        {
+            std::array<size_t, sizeof...(Args)> slots {};
+            size_t                               named = 0;
+            size_t                               i     = 0;
+            ((slots[i++] = IsContext<Args> ? SIZE_MAX : named++), ...);
+            return slots;
+        }
+
+        template <typename T>
+        decltype(auto) DecodeArg(const CallContext& context, Envelope& envelope, const char* name)
+        {
+            typedef std::remove_cvref_t<T> Value;
+
+            if constexpr(IsContext<T>)
+            {
+                return (context);
+            }
+            else
+            {
+                // 首次读取参数时才解析args
+                const Json& args = envelope.GetArgs();
+
+                auto it = args.find(name);
+                if(it == args.end())
+                {
+                    if constexpr(IsOptional<Value>::value)
+                        return Value {};
+                    else
+                        throw BridgeError("missing_argument", String("Missing argument: ") + name, name);
+                }
+
+                try
+                {
+                    return ArgDecoder<Value>::Decode(*it);
+                }
+                catch(const BridgeError&)
+                {
+                    throw;
+                }
+                catch(const std::exception& e)
+                {
+                    throw BridgeError("invalid_argument", String("Invalid argument ") + name + ": " + e.what(), name);
+                }
+            }
+        }
+
+        template <typename R, typename... Args, size_t... I>
+        Object Invoke(R (*func)(Args...),
+            const std::array<const char*, NamedCount<Args...>>& names,
+            const CallContext&                                   context,
+            Envelope&                                            envelope,
+            std::index_sequence<I...>)
+        {
+            constexpr auto slots = NameSlots<Args...>();
+            if constexpr(std::is_void_v<R>)
+            {
+                func(DecodeArg<Args>(context, envelope, slots[I] < names.size() ? names[slots[I]] : nullptr)...);
+                return "success";
+            }
+            else
+            {
+                return Object(
+                    func(DecodeArg<Args>(context, envelope, slots[I] < names.size() ? names[slots[I]] : nullptr)...));
+            }
+        }
+
+        // 根据函数签名在编译期生成参数解码和返回值编码
+        // CallContext参数由调用方传入，其余参数依次对应names
+        template <typename R, typename... Args>
+        auto Bind(R (*func)(Args...), std::array<const char*, NamedCount<Args...>> names)
+        {
+            return [func, names](const CallContext& context, Envelope& envelope) -> Object
+            { return Invoke(func, names, context, envelope, std::index_sequence_for<Args...> {}); };
+        }
+    }
+}
@@ -1,41 +1,241 @@
 #pragma once
 #include "platform.hpp"
 #include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "json.hpp"
-
-#if OS(WINDOWS)
-    #include <WebView2.h>
-    #include <wil/com.h>
-#endif
+#include "binding.hpp"
+#include "memo.hpp"
+#include "metrics.hpp"
+#include "recorder.hpp"
+#include "stream.hpp"
+#include "task.hpp"
+#include "transport.hpp"
+#include "workers.hpp"
 
 namespace ezi
 {
-    typedef std::function<Object(Object)>        Function;
-    typedef std::unordered_map<String, Function> Functions;
+    typedef std::function<Object(Object)>                        Function;
+    typedef std::function<Object(const CallContext&, Object)>    ContextFunction;
+    typedef std::function<Object(const CallContext&, Envelope&)> Handler;
+    typedef std::function<Task(Object)>                          AsyncFunction;
+    typedef std::function<Task(CallContext, Object)>             ContextAsyncFunction;
+    typedef std::function<std::future<Object>(Object)>           FutureFunction;
+    typedef std::function<void(Object, ResponseStream&)>         StreamFunction;
+    typedef std::function<void(Json)>                            Reply;
+
+    // 函数编号，即函数表中的下标
+    typedef uint32_t FunctionId;
+
+    struct FunctionEntry
+    {
+        String                    name;
+        Handler                   handler;
+        ContextAsyncFunction      async;
+        StreamFunction            stream;
+        Priority                  priority = Priority::normal;
+        // 大于0时为幂等函数，结果缓存该时长
+        std::chrono::milliseconds memoTtl = std::chrono::milliseconds::zero();
+
+        std::shared_ptr<FunctionMetrics> metrics = std::make_shared<FunctionMetrics>();
+    };
+
+    typedef std::vector<std::shared_ptr<FunctionMetrics>> MetricsList;
+
+    // 排队统计，按优先级分别记录
+    struct QueueStats
+    {
+        uint64_t submitted   = 0;
+        uint64_t rejected    = 0;
+        size_t   depth       = 0;
+        size_t   maxDepth    = 0;
+        double   totalWaitMs = 0;
+        double   maxWaitMs   = 0;
+    };
+
+    typedef std::array<QueueStats, static_cast<size_t>(Priority::count)> QueueStatsList;
+
+    typedef std::vector<FunctionEntry>             FunctionTable;
+    typedef std::unordered_map<String, FunctionId> FunctionIds;
+
+    struct Channel
+    {
+        std::shared_ptr<Transport> transport;
+        WireFormat                 allowed = WireFormat::json;
+        WireFormat                 format  = WireFormat::json;
+
+        // 页面订阅的事件主题
+        std::unordered_set<String> topics;
+        // 待合并发送的事件，每个主题只保留最新值
+        Json                       coalesced = Json::object();
+        bool                       flushing  = false;
+    };
 
-#if OS(WINDOWS)
-    typedef wil::com_ptr<ICoreWebView2> View;
-    typedef HWND                        WinId;
-#endif
     class Bridge
     {
     private:
-        Functions functions;
+        FunctionTable functions;
+        FunctionIds   functionIds;
+        String        functionIdsScript;
+        bool          frozen = false;
+
+        std::unique_ptr<WorkerPool> workers;
+        size_t                      workerCount = 0;
+        // 流式函数在等待页面归还额度时阻塞，使用单独的线程池，不占用普通调用的工作线程
+        std::unique_ptr<WorkerPool> streamWorkers;
+        size_t                      streamWorkerCount = 2;
+        size_t                      streamWindow      = 8;
+        std::chrono::milliseconds   streamTimeout     = std::chrono::seconds(30);
+        size_t                      queueLimit        = 64;
+        size_t                      ringCapacity      = 8 << 20;
+        size_t                      ringThreshold     = 16 << 10;
+
+        std::mutex                        queueMutex;
+        QueueStatsList                    queueStats;
+        std::unordered_map<WinId, size_t> queueDepths;
+
+        // 进行中的流，按窗口和调用id索引
+        std::mutex                                                                             streamMutex;
+        std::unordered_map<WinId, std::unordered_map<String, std::shared_ptr<ResponseStream>>> streams;
+
+        // 进行中的异步和流式调用，按窗口和调用id索引
+        std::mutex                                                               inflightMutex;
+        std::unordered_map<WinId, std::unordered_map<String, CancellationToken>> inflight;
+
+        std::mutex                         channelMutex;
+        std::unordered_map<WinId, Channel> channels;
+
+        Recorder  recorder;
+        MemoCache memo;
+
+        std::unordered_set<String> coalescedTopics = { "window.moved", "window.resized" };
+        std::chrono::milliseconds  eventFrame      = std::chrono::milliseconds(16);
 
     private:
-        Bridge()                         = default;
+        Bridge();
         Bridge(const Bridge&)            = delete;
         Bridge& operator=(const Bridge&) = delete;
 
+        WorkerPool&                GetWorkers();
+        WorkerPool&                GetStreamWorkers();
+        FunctionEntry&             Intern(String name);
+        FunctionEntry&             Define(String name,
+            Handler              handler,
+            ContextAsyncFunction async,
+            StreamFunction       stream);
+        const FunctionEntry*       Find(const Json& func) const;
+        const FunctionEntry*       Find(const String& name) const;
+        Json                       Invoke(const FunctionEntry& entry, const CallContext& context, Envelope& envelope);
+        void                       InvokeAsync(const CallContext& context,
+            const FunctionEntry& entry,
+            Json                 args,
+            Reply                reply);
+        void                       InvokeStream(const CallContext& context,
+            const FunctionEntry& entry,
+            Json                 id,
+            Json                 args,
+            Reply                reply);
+        CancellationToken          Track(WinId winId, const Json& id);
+        void                       Untrack(WinId winId, const Json& id);
+        bool                       Enqueue(WorkerPool& pool, WinId winId, Priority priority, Job job);
+        void                       EraseStream(WinId winId, const Json& id);
+        void                       CloseStreams(WinId winId);
+        void                       PostToWindow(WinId winId, Job job);
+        std::shared_ptr<Transport> GetTransport(WinId winId);
+        void                       OnMessage(WinId winId,
+            Payload           payload,
+            WireFormat        format,
+            Clock::time_point received);
+        void                       RejectFormat(WinId winId, Payload payload);
+        void                       Dispatch(WinId winId, Envelope& envelope, Reply reply);
+        void                       DispatchBatch(WinId winId, std::vector<Envelope>& calls, Reply reply);
+        SendTiming                 Send(WinId winId, Json message, WireFormat format);
+        MetricsList                CollectMetrics(const std::vector<Envelope>& calls) const;
+        Object                     Negotiate(const CallContext& context, Object args);
+        Object                     Ack(const CallContext& context, Object args);
+        Object                     Subscribe(const CallContext& context, Object args, bool subscribe);
+        Object                     OpenRing(const CallContext& context);
+        Object                     Release(const CallContext& context, Object args);
+        Object                     Cancel(const CallContext& context, Object args);
+        void                       SendEvents(WinId winId, Json events);
+        void                       FlushEvents(WinId winId);
+
     public:
         static Bridge& GetInstance();
 
     public:
-        void ExposeTo(View& view, WinId winId);
-        Json Call(String func, Json args);
+#if OS(WINDOWS)
+        void ExposeTo(View& view, WinId winId, WireFormat allowed = WireFormat::msgpack);
+#endif
+        // 把消息通道挂到窗口上，winId只作为标识，不要求是真实窗口
+        void Attach(WinId winId, std::shared_ptr<Transport> transport, WireFormat allowed = WireFormat::msgpack);
+        void Detach(WinId winId);
+        // 发布函数编号表；之后注册或修改函数会抛出异常
+        void Freeze();
+        Json Call(const String& func, const Json& args, const CallContext& context = {});
+        void CallAsync(const String& func, Json args, Reply reply);
         void Register(String name, Function func);
+        void Register(String name, ContextFunction func);
+        void RegisterAsync(String name, AsyncFunction func, Priority priority = Priority::normal);
+        void RegisterAsync(String name, ContextAsyncFunction func, Priority priority = Priority::normal);
+        // future在工作线程上阻塞等待，等待期间占用该线程
+        void RegisterAsync(String name, FutureFunction func, Priority priority = Priority::normal);
+        void RegisterStream(String name, StreamFunction func, Priority priority = Priority::normal);
+
+        // 向订阅了该主题的页面推送事件，target为空时发给所有窗口
+        // 高频主题按帧合并，只发送最新值；可在任意线程调用
+        void Emit(const String& topic, Json payload, WinId target = nullptr);
+
+        // 在调用线程上执行流式函数，数据块写出后立即归还额度并丢弃，返回写出的块数
+        uint64_t CallStream(const String& func, Json args);
+
+        // 按函数签名绑定，names依次为各参数在args中的键名，CallContext参数不占键名
+        template <typename R, typename... Args, typename... Names>
+            requires(Binding::NamedCount<Args...> == sizeof...(Names))
+        void Register(String name, R (*func)(Args...), Names... names)
+        {
+            Define(std::move(name), Binding::Bind(func, { names... }), nullptr, nullptr);
+        }
+
+    public:
+        static WireFormat ParseWireFormat(const String& name);
+        static Priority   ParsePriority(const String& name);
+
+        FunctionId GetFunctionId(const String& name) const;
+        bool       IsAsync(const String& name) const;
+        bool       IsStream(const String& name) const;
+        Json       GetFunctionIds() const;
+
+        void SetWorkerCount(size_t count);
+        void SetStreamWindow(size_t window);
+        // 流式函数的线程数，以及等待页面归还额度的最长时间，0为一直等待
+        void SetStreamWorkers(size_t count);
+        void SetStreamTimeout(std::chrono::milliseconds timeout);
+        void SetQueueLimit(size_t limit);
+        void SetPriority(const String& name, Priority priority);
+        void SetCoalesced(const String& topic, bool coalesced);
+        void SetEventFrame(std::chrono::milliseconds frame);
+        void SetRing(size_t capacity, size_t threshold);
+        // 把同步函数标记为幂等：相同参数的并发调用只执行一次，结果在ttl内复用
+        // invalidatedBy中的主题发出事件时立即失效；结果只能取决于参数，不能取决于发送方窗口
+        void SetIdempotent(const String& name,
+            std::chrono::milliseconds  ttl,
+            const std::vector<String>& invalidatedBy = {});
+        // 取消窗口上所有进行中的调用，窗口关闭或页面跳转时调用
+        void CancelWindow(WinId winId);
+        // 录制页面发来的调用，供 ezi-replay 回放
+        bool StartRecording(const String& path);
+        void StopRecording();
+        Json GetQueueStats();
+        Json GetMetrics() const;
+        void Pump(WinId winId);
     };
-} // namespace ezi
\ No newline at end of file
+} // namespace ezi
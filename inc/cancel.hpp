@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ezi
+{
+    // 取消令牌
+    // 副本共享同一状态；默认构造的令牌永远不会被取消
+    // 处理函数可以轮询，或在工作线程上阻塞等待取消
+    class CancellationToken
+    {
+    private:
+        struct State
+        {
+            std::atomic<bool>                  cancelled = false;
+            std::mutex                         mutex;
+            std::condition_variable            condition;
+            std::vector<std::function<void()>> callbacks;
+        };
+
+        std::shared_ptr<State> state;
+
+    public:
+        CancellationToken() = default;
+        static CancellationToken Create();
+
+    public:
+        bool IsCancelled() const;
+        // 已取消时抛出 BridgeError("cancelled")
+        void ThrowIfCancelled() const;
+        // 等待取消或超时，已取消时返回true
+        bool WaitFor(std::chrono::milliseconds timeout) const;
+        // 取消时在调用Cancel的线程上执行，已取消时立即执行；回调应当简短
+        void OnCancel(std::function<void()> callback) const;
+        void Cancel() const;
+    };
+}
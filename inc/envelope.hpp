@@ -0,0 +1,50 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.hpp"
+
+namespace ezi
+{
+    // 桥接消息的编码格式
+    enum class WireFormat
+    {
+        json,
+        msgpack
+    };
+
+    // 原始消息，由信封共享持有
+    typedef std::shared_ptr<const std::string> Payload;
+
+    // 请求信封
+    // 解析时只取出id和func，args保留为原始消息中的片段，处理函数首次读取时才解析
+    class Envelope
+    {
+    private:
+        Payload          payload;
+        WireFormat       format = WireFormat::json;
+        std::string_view rawArgs;
+        Json             id;
+        Json             func;
+        Json             args   = Json::object();
+        bool             parsed = true;
+
+    public:
+        Envelope() = default;
+        // 本地调用，参数已是Json
+        explicit Envelope(Json args);
+
+    public:
+        // 解析消息，消息为数组时返回true
+        static bool Open(Payload payload, WireFormat format, std::vector<Envelope>& calls);
+
+        const Json&      GetId() const;
+        const Json&      GetFunc() const;
+        std::string_view GetRawArgs() const;
+        WireFormat       GetFormat() const;
+        const Json&      GetArgs();
+        Json             TakeArgs();
+    };
+}
@@ -5,3 +5,16 @@
 #define REG(space, func)                                                                                               \
     ezi::Bridge::GetInstance().Register(#space "." #func, func);                                                       \
     println("Registered function:", #space "." #func)
+
+// 类型化注册，其后依次为各参数的键名
+#define REG_ARGS(space, func, ...)                                                                                     \
+    ezi::Bridge::GetInstance().Register(#space "." #func, func, __VA_ARGS__);                                          \
+    println("Registered function:", #space "." #func)
+
+#define REG_ASYNC(space, func)                                                                                         \
+    ezi::Bridge::GetInstance().RegisterAsync(#space "." #func, func);                                                  \
+    println("Registered async function:", #space "." #func)
+
+#define REG_STREAM(space, func)                                                                                        \
+    ezi::Bridge::GetInstance().RegisterStream(#space "." #func, func);                                                 \
+    println("Registered stream function:", #space "." #func)
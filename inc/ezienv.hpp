@@ -28,6 +28,10 @@ namespace ezi
     public:
         static EziEnv& GetInstance();
 
+        // env文件为msgpack编码的对象；文件不存在时返回null，内容损坏时抛出 Json::parse_error
+        static Json LoadFile(const String& path);
+        static void SaveFile(const String& path, const Json& data);
+
         Position GetRememberedWindowPosition();
         void     SetRememberedWindowPosition(const Position& pos);
         bool     PermissionRequest(std::string permissionName);
@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+
+#include "assetpack.hpp"
+#include "json.hpp"
+
+namespace ezi
+{
+    // 映射到内存的资源包，用于没有RCDATA资源的平台
+    // 只读共享映射：页面在首次访问时才从文件载入，多个进程打开同一个包时共用页缓存中的同一份物理页
+    // 资源数据保持内核默认的预读，末尾的索引在打开时提示提前载入
+    class MappedPack
+    {
+    private:
+        BinaryData data;
+        void*      mapping    = nullptr;
+        size_t     mappedSize = 0;
+
+    private:
+        MappedPack(BinaryData data, void* mapping, size_t mappedSize);
+        MappedPack(const MappedPack&)            = delete;
+        MappedPack& operator=(const MappedPack&) = delete;
+
+        void Advise();
+
+    public:
+        ~MappedPack();
+
+        // 文件不存在或无法映射时抛出异常
+        static std::unique_ptr<MappedPack> Open(const String& path);
+        // 由 ezi_embed_assets 链接进程序的 ezi_assets 段，没有链接时返回空
+        static std::unique_ptr<MappedPack> FromExecutable();
+        // EZI_ASSETS 环境变量指定的路径，否则为程序所在目录下的 ezi.assets
+        static String GetDefaultPath();
+
+    public:
+        BinaryData GetData() const;
+    };
+}
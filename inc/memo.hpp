@@ -0,0 +1,59 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "json.hpp"
+#include "metrics.hpp"
+
+namespace ezi
+{
+    // 幂等函数的结果缓存
+    // 以函数名和参数为键；同一键的并发调用共用一次执行，结果在ttl内或失效事件到来前复用
+    // 执行失败的结果不缓存，执行期间发生失效的结果也不缓存
+    // 执行中的函数在同一线程上再次以相同参数调用时直接执行，不等待自身的结果
+    // 每个函数最多缓存MAXSLOTS个结果，满时先移除过期的结果，仍然满时移除全部已完成的结果
+    class MemoCache
+    {
+    public:
+        typedef std::function<Json()> Compute;
+
+    private:
+        struct Slot
+        {
+            std::shared_future<Json> result;
+            Clock::time_point        expires;
+            std::thread::id          owner;
+            bool                     ready = false;
+        };
+
+        typedef std::unordered_map<std::string, std::shared_ptr<Slot>> Slots;
+
+        static constexpr size_t MAXSLOTS = 256;
+
+        std::mutex                                      mutex;
+        std::unordered_map<String, Slots>               functions;
+        std::unordered_map<String, std::vector<String>> topics;
+
+    private:
+        static void Sweep(Slots& slots);
+
+    public:
+        // invalidatedBy中任一主题的事件发出时清空该函数的缓存
+        void SetTopics(const String& func, const std::vector<String>& invalidatedBy);
+        // hit在结果来自缓存或其他调用的执行时置为true
+        Json Get(const String& func,
+            const std::string&        key,
+            std::chrono::milliseconds ttl,
+            const Compute&            compute,
+            bool&                     hit);
+        void Invalidate(const String& topic);
+        void Clear();
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "json.hpp"
+
+namespace ezi
+{
+    // 对数分桶的延迟直方图（HDR风格），纳秒记录，相对误差约1/16
+    // 只使用relaxed原子操作，可在任意线程记录
+    class Histogram
+    {
+    public:
+        static constexpr int    SUBBITS = 4;
+        static constexpr int    MAXEXP  = 40;
+        static constexpr size_t BUCKETS = (1 << SUBBITS) * (MAXEXP - SUBBITS + 2);
+
+    private:
+        std::array<std::atomic<uint32_t>, BUCKETS> buckets {};
+        std::atomic<uint64_t>                      count { 0 };
+        std::atomic<uint64_t>                      total { 0 };
+        std::atomic<uint64_t>                      max { 0 };
+
+    public:
+        static size_t   BucketOf(uint64_t value);
+        static uint64_t ValueOf(size_t bucket);
+
+    public:
+        void     Record(uint64_t ns);
+        uint64_t Percentile(double percent) const;
+        uint64_t GetCount() const;
+        Json     ToJson() const;
+    };
+
+    enum class Phase
+    {
+        parse,
+        dispatch,
+        serialize,
+        post,
+        count
+    };
+
+    struct FunctionMetrics
+    {
+        std::atomic<uint64_t> calls { 0 };
+        std::atomic<uint64_t> errors { 0 };
+        std::atomic<uint64_t> memoHits { 0 };
+
+        std::array<Histogram, static_cast<size_t>(Phase::count)> phases;
+
+        void Record(Phase phase, uint64_t ns) { phases[static_cast<size_t>(phase)].Record(ns); }
+        Json ToJson() const;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    inline uint64_t ElapsedNs(Clock::time_point since)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    }
+}
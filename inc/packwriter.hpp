@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "assetpack.hpp"
+#include "json.hpp"
+
+struct ZSTD_CDict_s;
+
+namespace ezi
+{
+    struct CompressDictionaryDeleter
+    {
+        void operator()(ZSTD_CDict_s* dictionary) const;
+    };
+
+    typedef std::unique_ptr<ZSTD_CDict_s, CompressDictionaryDeleter> CompressDictionary;
+
+    // 资源包末尾的索引格式，json为旧的zstd压缩json清单，供旧版本读取
+    enum class IndexFormat
+    {
+        binary,
+        json
+    };
+
+    // 资源包的写入，格式见 AssetPack
+    // 压缩和写入分开：静态的 Compress / CompressSeekable 可在多个线程同时调用，结果再按顺序写入
+    class AssetPackWriter
+    {
+    private:
+        std::vector<uint8_t>                             data;
+        Json                                             manifest = Json::object();
+        std::unordered_map<String, std::vector<uint8_t>> dictionaries;
+        std::map<std::pair<String, int>, CompressDictionary> prepared;
+
+    private:
+        Json Append(BinaryData content);
+
+    public:
+        // 用同类资源的内容训练字典，样本太少时训练失败，返回空
+        static std::vector<uint8_t> TrainDictionary(const std::vector<BinaryData>& samples, size_t capacity = 64 << 10);
+        // 压缩为单个zstd帧，每个线程复用自己的压缩上下文；使用字典时级别取自字典
+        static std::vector<uint8_t> Compress(
+            BinaryData content, int level = 19, const ZSTD_CDict_s* dictionary = nullptr);
+        // 按frameSize切成独立帧并附加跳转表，供 AssetStream 按范围读取
+        static std::vector<uint8_t> CompressSeekable(BinaryData content, int level = 19, size_t frameSize = 256 << 10);
+
+    public:
+        void AddDictionary(const String& name, std::vector<uint8_t> dictionary);
+        // 按级别预处理好的字典，可在多个线程同时用于 Compress；本身不能与其他成员函数并发调用
+        const ZSTD_CDict_s* GetCompressDictionary(const String& name, int level);
+        // dictionary为空时单独压缩
+        void Add(const String& uri, BinaryData content, int level = 19, const String& dictionary = "");
+        void AddSeekable(const String& uri, BinaryData content, int level = 19, size_t frameSize = 256 << 10);
+        // 写入已压缩的数据，dictionary为压缩时使用的字典名
+        void AddCompressed(const String& uri, BinaryData compressed, const String& dictionary = "");
+        // 写入 CompressSeekable 的结果，索引中标记为可按范围读取
+        void AddCompressedSeekable(const String& uri, BinaryData compressed);
+        // 不压缩直接存放，用于已压缩的格式，读取时不需要解压和复制
+        void AddStored(const String& uri, BinaryData content);
+        // 与target共用同一份数据，用于内容相同的资源
+        void AddAlias(const String& uri, const String& target);
+        // 写入索引，返回完整的资源包；level只用于压缩json清单
+        // json清单供旧版本读取，不能包含直接存放的资源、字典和多帧的分帧资源，否则抛出异常
+        std::vector<uint8_t> Finish(IndexFormat format = IndexFormat::binary, int level = 19);
+    };
+}
@@ -117,4 +117,115 @@ inline std::string utf8ToGbk(const std::string& utf8_str)
     return utf16ToGbk(wide_str);
 }
 
-#endif
\ No newline at end of file
+#else
+    #include <cstdint>
+    #include <string>
+
+// 其他平台的utf8与宽字符互转，wchar_t为4字节时直接存放码点；无效的序列替换为U+FFFD
+inline std::string utf16ToUtf8(const std::wstring& utf16_str)
+{
+    std::string utf8;
+    utf8.reserve(utf16_str.size());
+    for(size_t i = 0; i < utf16_str.size(); i++)
+    {
+        uint32_t code = static_cast<uint32_t>(utf16_str[i]);
+        if constexpr(sizeof(wchar_t) == 2)
+        {
+            if(code >= 0xD800 && code < 0xDC00 && i + 1 < utf16_str.size())
+            {
+                uint32_t low = static_cast<uint32_t>(utf16_str[i + 1]);
+                if(low >= 0xDC00 && low < 0xE000)
+                {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i++;
+                }
+            }
+        }
+        if((code >= 0xD800 && code < 0xE000) || code > 0x10FFFF)
+            code = 0xFFFD;
+
+        if(code < 0x80)
+        {
+            utf8 += static_cast<char>(code);
+        }
+        else if(code < 0x800)
+        {
+            utf8 += static_cast<char>(0xC0 | (code >> 6));
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if(code < 0x10000)
+        {
+            utf8 += static_cast<char>(0xE0 | (code >> 12));
+            utf8 += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            utf8 += static_cast<char>(0xF0 | (code >> 18));
+            utf8 += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            utf8 += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    return utf8;
+}
+
+inline std::wstring utf8ToUtf16(const std::string& utf8_str)
+{
+    static constexpr uint32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+    std::wstring wide;
+    wide.reserve(utf8_str.size());
+    size_t size = utf8_str.size();
+    for(size_t i = 0; i < size;)
+    {
+        uint8_t  lead   = static_cast<uint8_t>(utf8_str[i]);
+        size_t   length = 0;
+        uint32_t code   = 0;
+        if(lead < 0x80)
+        {
+            length = 1;
+            code   = lead;
+        }
+        else if((lead >> 5) == 0x06)
+        {
+            length = 2;
+            code   = lead & 0x1F;
+        }
+        else if((lead >> 4) == 0x0E)
+        {
+            length = 3;
+            code   = lead & 0x0F;
+        }
+        else if((lead >> 3) == 0x1E)
+        {
+            length = 4;
+            code   = lead & 0x07;
+        }
+
+        size_t read = 1;
+        while(read < length && i + read < size && (static_cast<uint8_t>(utf8_str[i + read]) & 0xC0) == 0x80)
+        {
+            code = (code << 6) | (static_cast<uint8_t>(utf8_str[i + read]) & 0x3F);
+            read++;
+        }
+        // 截断、过长编码、代理区和超出范围的码点
+        if(length == 0 || read < length || code < minimum[length] || (code >= 0xD800 && code < 0xE000)
+            || code > 0x10FFFF)
+            code = 0xFFFD;
+        i += read;
+
+        if(sizeof(wchar_t) == 2 && code >= 0x10000)
+        {
+            code -= 0x10000;
+            wide += static_cast<wchar_t>(0xD800 + (code >> 10));
+            wide += static_cast<wchar_t>(0xDC00 + (code & 0x3FF));
+        }
+        else
+        {
+            wide += static_cast<wchar_t>(code);
+        }
+    }
+    return wide;
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "envelope.hpp"
+#include "json.hpp"
+#include "metrics.hpp"
+
+namespace ezi
+{
+    // 录制的一次调用
+    struct RecordedCall
+    {
+        uint64_t    offsetNs = 0;
+        String      func;
+        String      sender;
+        WireFormat  format = WireFormat::json;
+        std::string args;
+
+        Json GetArgs() const;
+    };
+
+    // 桥接流量录制
+    // 文件以 "EZIR" 和4字节版本号开头，之后每条记录为4字节小端长度加一个msgpack对象
+    // 参数按收到时的原始字节保存，录制时不需要解析
+    class Recorder
+    {
+    private:
+        std::mutex        mutex;
+        std::ofstream     file;
+        Clock::time_point started;
+        std::atomic<bool> recording = false;
+
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        bool Start(const String& path);
+        void Stop();
+        bool IsRecording() const;
+        void Record(const String& func, const String& sender, WireFormat format, std::string_view args);
+
+        static std::vector<RecordedCall> Load(const String& path);
+    };
+}
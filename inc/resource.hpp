@@ -1,9 +1,13 @@
 #pragma once
 
 #include "platform.hpp"
+#include "assetcache.hpp"
+#include "assetpack.hpp"
+#include "assetstream.hpp"
 #include "json.hpp"
-#include <unordered_map>
-#include <span>
+#if OS(LINUX)
+    #include "mappedpack.hpp"
+#endif
 #if OS(WINDOWS)
     #include <gdiplus.h>
 using namespace Gdiplus;
@@ -11,21 +15,19 @@ using namespace Gdiplus;
 
 namespace ezi
 {
-    struct AssetMeta
-    {
-        size_t offset;
-        size_t size;
-    };
-
-    typedef std::span<const uint8_t>              BinaryData;
-    typedef std::unordered_map<String, AssetMeta> AssetMetaMap;
-
     class Resource
     {
     private:
-        AssetMetaMap assetsMetas;
-        BinaryData   assetsBinarys;
-        Json         config;
+#if OS(LINUX)
+        // 没有RCDATA资源的平台上资源包的映射，需比assets先构造、后析构
+        std::unique_ptr<MappedPack> pack;
+#elif !OS(WINDOWS)
+        // 不支持映射的平台上读入内存的资源包，需比assets先构造、后析构
+        std::vector<uint8_t> packData;
+#endif
+        AssetPack  assets;
+        AssetCache cache;
+        Json       config;
 
     private:
         Resource();
@@ -36,9 +38,17 @@ namespace ezi
     public:
         static Resource& GetInstance();
 
-        std::vector<uint8_t> GetAssetData(const String& uri);
+        // 解压结果经缓存共享，资源不存在时返回空；可在多个线程同时调用
+        AssetBuffer GetAssetData(const String& uri);
+        Json        GetCacheStats();
+        // 分帧存放的大资源按需解压，不经过缓存；其他资源返回空
+        std::unique_ptr<AssetStream> OpenAssetStream(const String& uri);
+        // 直接存放的资源在包内的数据，不经过缓存也不复制；其他资源返回空
+        BinaryData GetStoredAsset(const String& uri);
 
+#if OS(WINDOWS)
         Gdiplus::Image* GetImage(const String& uri);
+#endif
 
         Json& GetConfig();
 
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+
+namespace ezi
+{
+    // 环形缓冲区中的一段数据
+    struct RingSlice
+    {
+        uint64_t seq    = 0;
+        size_t   offset = 0;
+        size_t   length = 0;
+    };
+
+    // 共享内存上的单向环形缓冲区
+    // 本地写入数据后只把偏移和长度随消息发给页面，页面读取后按序号释放
+    // 每段数据在内存中连续存放，尾部放不下时跳到开头，页面可直接创建视图读取
+    class SharedRing
+    {
+    private:
+        struct Record
+        {
+            uint64_t end      = 0;
+            bool     released = false;
+        };
+
+        uint8_t*           base;
+        size_t             capacity;
+        uint64_t           head    = 0;
+        uint64_t           tail    = 0;
+        uint64_t           nextSeq = 0;
+        std::deque<Record> records;
+        std::mutex         mutex;
+
+    public:
+        static constexpr size_t ALIGNMENT = 8;
+
+        SharedRing(uint8_t* base, size_t capacity);
+
+    public:
+        // 写入数据，空间不足时返回空
+        std::optional<RingSlice> Write(std::span<const uint8_t> data);
+        // 释放后，该段之前的数据全部释放时才回收空间
+        bool Release(uint64_t seq);
+        // 页面重新加载后，之前的数据全部作废
+        void Reset();
+
+        size_t GetCapacity() const;
+        size_t GetUsed();
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "json.hpp"
+
+namespace ezi
+{
+    // 流式响应
+    // 处理函数在工作线程上逐块写入，每块作为 {id, seq, chunk} 单独发送
+    // 页面每处理完若干块回复 bridge.ack {id, count} 归还额度，额度用完时Write阻塞
+    // 超过timeout仍未归还额度时视为页面已停止读取，流随即关闭；timeout为0时一直等待
+    // 结束时发送 {id, seq, done: true, result}，seq为已发送的块数
+    class ResponseStream
+    {
+    public:
+        typedef std::function<void(uint64_t seq, Json chunk)> Sink;
+
+    private:
+        Sink                      sink;
+        std::mutex                mutex;
+        std::condition_variable   condition;
+        size_t                    credits;
+        std::chrono::milliseconds timeout;
+        uint64_t                  sequence = 0;
+        bool                      closed   = false;
+        bool                      timedOut = false;
+
+    private:
+        ResponseStream(const ResponseStream&)            = delete;
+        ResponseStream& operator=(const ResponseStream&) = delete;
+
+    public:
+        ResponseStream(size_t window, Sink sink, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    public:
+        bool     Write(Object chunk);
+        void     Ack(size_t count);
+        void     Close();
+        bool     IsClosed();
+        bool     IsTimedOut();
+        uint64_t GetSequence();
+    };
+}
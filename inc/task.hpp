@@ -0,0 +1,104 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+
+#include "json.hpp"
+
+namespace ezi
+{
+    // 异步桥接函数的协程返回类型
+    // 协程创建后处于挂起状态，由Bridge投递到工作线程后再开始执行
+    // 在协程内部可以 co_await 其他 Task
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            Object                  value;
+            std::exception_ptr      error;
+            std::coroutine_handle<> continuation;
+            std::function<void()>   onDone;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+                void await_resume() noexcept { }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    auto& promise = handle.promise();
+                    if(promise.continuation)
+                        return promise.continuation;
+                    // onDone可能会销毁协程帧，先移出再调用
+                    auto done = std::move(promise.onDone);
+                    if(done)
+                        done();
+                    return std::noop_coroutine();
+                }
+            };
+
+            Task                get_return_object() { return Task(Handle::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter        final_suspend() noexcept { return {}; }
+            void                return_value(Object result) { value = std::move(result); }
+            void                unhandled_exception() { error = std::current_exception(); }
+        };
+
+        typedef std::coroutine_handle<promise_type> Handle;
+
+    private:
+        Handle handle;
+
+    private:
+        explicit Task(Handle handle) : handle(handle) { }
+
+    public:
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) { }
+        Task& operator=(Task&& other) noexcept
+        {
+            if(this != &other)
+            {
+                if(handle)
+                    handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task&)            = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task()
+        {
+            if(handle)
+                handle.destroy();
+        }
+
+    public:
+        // 开始执行，完成后在执行完成的线程上调用onDone
+        void Start(std::function<void()> onDone)
+        {
+            handle.promise().onDone = std::move(onDone);
+            handle.resume();
+        }
+
+        Object TakeResult()
+        {
+            auto& promise = handle.promise();
+            if(promise.error)
+                std::rethrow_exception(promise.error);
+            return std::move(promise.value);
+        }
+
+    public:
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        Object await_resume() { return TakeResult(); }
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "platform.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "envelope.hpp"
+#include "json.hpp"
+#include "metrics.hpp"
+#include "ring.hpp"
+#include "workers.hpp"
+
+#if OS(WINDOWS)
+    #include <WebView2.h>
+    #include <wil/com.h>
+
+    // 工作线程完成异步调用后，通知所属窗口线程回传结果
+    #define WM_EZI_BRIDGE (WM_APP + 0x20)
+#endif
+
+namespace ezi
+{
+    struct SendTiming
+    {
+        uint64_t serializeNs = 0;
+        uint64_t postNs      = 0;
+    };
+
+    // 桥接消息通道
+    // 负责消息的收发，并把任务送回所属线程执行；消息原样交给Bridge解析
+    class Transport
+    {
+    public:
+        typedef std::function<void(Payload payload, WireFormat format, Clock::time_point received)> Receiver;
+
+    private:
+        struct Delayed
+        {
+            Clock::time_point due;
+            Job               job;
+        };
+
+        Receiver             receiver;
+        std::mutex           mutex;
+        std::vector<Job>     pending;
+        std::vector<Delayed> delayed;
+
+    protected:
+        std::unique_ptr<SharedRing> ring;
+
+    protected:
+        void         Receive(Payload payload, WireFormat format, Clock::time_point received);
+        virtual void Wake() { }
+        // 延迟任务到期时唤醒，未实现时由调用方自行定期Pump
+        virtual void WakeAfter([[maybe_unused]] std::chrono::milliseconds delay) { }
+
+    public:
+        virtual ~Transport() = default;
+
+    public:
+        void   SetReceiver(Receiver receiver);
+        void   Post(Job job);
+        void   PostDelayed(Job job, std::chrono::milliseconds delay);
+        size_t Pump();
+
+        virtual SendTiming Send(const Json& message, WireFormat format) = 0;
+        virtual void       Close() { }
+
+        // 打开用于传递大块二进制数据的共享环形缓冲区，不支持时返回false
+        // 已打开时重置并重新交给页面
+        virtual bool OpenRing([[maybe_unused]] size_t capacity) { return false; }
+        SharedRing*  GetRing() const;
+    };
+
+    // 进程内回环通道，不依赖WebView
+    // Deliver在调用线程上完成同步派发，异步结果在调用Pump的线程上发出
+    class LoopbackTransport : public Transport
+    {
+    public:
+        typedef std::function<void(std::string_view payload, WireFormat format)> Output;
+
+    private:
+        Output               output;
+        std::string          buffer;
+        std::vector<uint8_t> ringMemory;
+
+    public:
+        explicit LoopbackTransport(Output output);
+
+    public:
+        void           Deliver(std::string payload, WireFormat format = WireFormat::json);
+        SendTiming     Send(const Json& message, WireFormat format) override;
+        bool           OpenRing(size_t capacity) override;
+        const uint8_t* GetRingMemory() const;
+    };
+
+#if OS(WINDOWS)
+    typedef wil::com_ptr<ICoreWebView2> View;
+
+    class WebViewTransport : public Transport
+    {
+    private:
+        View                                    view;
+        HWND                                    winId;
+        EventRegistrationToken                  token {};
+        wil::com_ptr<ICoreWebView2SharedBuffer> sharedBuffer;
+
+    protected:
+        void Wake() override;
+        void WakeAfter(std::chrono::milliseconds delay) override;
+
+    public:
+        WebViewTransport(View view, HWND winId);
+
+    public:
+        SendTiming Send(const Json& message, WireFormat format) override;
+        void       Close() override;
+        bool       OpenRing(size_t capacity) override;
+    };
+#endif
+}
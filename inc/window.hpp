@@ -61,6 +61,7 @@ namespace ezi
         View         view;
         WindowStatus status;
         String       accentColor;
+        String       bridgeFormat;
         Splash       splash;
 
         std::function<bool()> onCloseCallback;
@@ -84,6 +85,7 @@ namespace ezi
         float        GetScaleFactor() const;
         String       GetTitle() const;
         String       GetAccentColor() const;
+        String       GetBridgeFormat() const;
         Splash&      GetSplash();
 
         BackgroundMode GetBackgroundMode() const;
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ezi
+{
+    typedef std::function<void()> Job;
+
+    // 优先级，数值越小越先执行
+    enum class Priority
+    {
+        interactive,
+        normal,
+        bulk,
+        count
+    };
+
+    struct QueuedJob
+    {
+        Job                                   job;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    typedef std::array<std::deque<QueuedJob>, static_cast<size_t>(Priority::count)> JobQueues;
+
+    // 按优先级取任务；低优先级的任务等待超过aging后先于高优先级执行，持续的高优先级任务不会让其一直得不到执行
+    class WorkerPool
+    {
+    private:
+        std::vector<std::thread>  threads;
+        JobQueues                 jobs;
+        std::mutex                mutex;
+        std::condition_variable   condition;
+        std::chrono::milliseconds aging;
+        bool                      stopping = false;
+
+    private:
+        WorkerPool(const WorkerPool&)            = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        void Loop();
+        bool HasJobs() const;
+        Job  Take();
+
+    public:
+        explicit WorkerPool(size_t size, std::chrono::milliseconds aging = std::chrono::milliseconds(100));
+        ~WorkerPool();
+
+    public:
+        void   Submit(Job job, Priority priority = Priority::normal);
+        size_t GetSize() const;
+    };
+}
@@ -11,6 +11,8 @@
 #include "ezienv.hpp"
 #include "tray.hpp"
 #include "dialog.hpp"
+#include "binding.hpp"
+#include "bridge.hpp"
 
 namespace ezi
 {
@@ -88,11 +90,16 @@ namespace ezi
         }
 
         windows.push_back(window);
+        Bridge::GetInstance().Emit("window.created",
+            { { "winId", std::to_string(reinterpret_cast<uintptr_t>(window->GetWinId())) } });
         return *window;
     }
 
     void Application::DelWindowById(WinId winId)
     {
+        // 窗口上进行中的调用不再需要结果
+        Bridge::GetInstance().CancelWindow(winId);
+
         auto isMaster        = (masterWindow && masterWindow->GetWinId() == winId);
         auto isRecordPostion = false;
 
@@ -148,6 +155,12 @@ namespace ezi
         throw std::runtime_error("Window not found");
     }
 
+    Window& ArgDecoder<Window>::Decode(const Json& value)
+    {
+        WinId winId = reinterpret_cast<WinId>(std::stoull(value.get_ref<const String&>()));
+        return Application::GetInstance().GetWindowById(winId);
+    }
+
     WindowList& Application::GetWindowList()
     {
         return windows;
@@ -0,0 +1,81 @@
+#include "assetcache.hpp"
+
+namespace ezi
+{
+    AssetCache::AssetCache(size_t budget) : budget(budget)
+    {
+    }
+
+    AssetBuffer AssetCache::Get(const String& uri)
+    {
+        std::lock_guard lock(mutex);
+        auto            it = index.find(uri);
+        if(it == index.end())
+        {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->buffer;
+    }
+
+    void AssetCache::Put(const String& uri, AssetBuffer buffer)
+    {
+        if(!buffer)
+            return;
+
+        std::lock_guard lock(mutex);
+        if(buffer->size() > budget)
+            return;
+
+        // 并发未命中时可能重复放入，保留先放入的一份
+        if(index.contains(uri))
+            return;
+
+        Evict(budget - buffer->size());
+        used += buffer->size();
+        entries.push_front({ uri, std::move(buffer) });
+        index[uri] = entries.begin();
+    }
+
+    void AssetCache::Evict(size_t target)
+    {
+        while(used > target && !entries.empty())
+        {
+            auto& last = entries.back();
+            used -= last.buffer->size();
+            index.erase(last.uri);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    void AssetCache::SetBudget(size_t budget)
+    {
+        std::lock_guard lock(mutex);
+        this->budget = budget;
+        Evict(budget);
+    }
+
+    void AssetCache::Clear()
+    {
+        std::lock_guard lock(mutex);
+        entries.clear();
+        index.clear();
+        used = 0;
+    }
+
+    Json AssetCache::GetStats()
+    {
+        std::lock_guard lock(mutex);
+        return {
+            { "hits", hits },
+            { "misses", misses },
+            { "evictions", evictions },
+            { "entries", entries.size() },
+            { "bytes", used },
+            { "budget", budget },
+        };
+    }
+}
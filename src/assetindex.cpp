@@ -0,0 +1,260 @@
+#include "assetindex.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace ezi
+{
+    // 索引按结构体的内存布局写入和读取，不逐字段转换字节序，大端平台上读写的包不兼容
+    static_assert(std::endian::native == std::endian::little, "AssetIndex requires a little-endian platform");
+
+    namespace Private
+    {
+        static size_t BucketOf(uint64_t hash, uint32_t bits)
+        {
+            return bits ? static_cast<size_t>(hash >> (64 - bits)) : 0;
+        }
+    }
+
+    uint64_t AssetIndex::Hash(std::string_view text)
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        for(unsigned char c : text)
+        {
+            hash = (hash ^ c) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    bool AssetIndex::Has(BinaryData pack)
+    {
+        return pack.size() >= FOOTERSIZE
+               && !std::memcmp(pack.data() + pack.size() - sizeof(MAGIC), MAGIC, sizeof(MAGIC));
+    }
+
+    std::vector<uint8_t> AssetIndex::Build(const std::vector<std::pair<String, AssetMeta>>& entries,
+        const std::vector<std::pair<String, AssetMeta>>&                                     dictionaries)
+    {
+        std::vector<std::pair<uint64_t, size_t>> order;
+        for(size_t i = 0; i < entries.size(); i++)
+        {
+            order.emplace_back(Hash(entries[i].first), i);
+        }
+        // 哈希相同时按uri排列，保证输出稳定
+        std::sort(order.begin(),
+            order.end(),
+            [&entries](auto& a, auto& b)
+            { return a.first != b.first ? a.first < b.first : entries[a.second].first < entries[b.second].first; });
+        for(size_t i = 1; i < order.size(); i++)
+        {
+            if(entries[order[i - 1].second].first == entries[order[i].second].first)
+                throw std::runtime_error("Duplicate asset: " + entries[order[i].second].first);
+        }
+
+        String pool;
+        auto   intern = [&pool](const String& text)
+        {
+            if(pool.size() + text.size() > UINT32_MAX)
+                throw std::runtime_error("Asset index too large");
+            auto offset = static_cast<uint32_t>(pool.size());
+            pool += text;
+            return offset;
+        };
+
+        // 桶数不少于条目数，平均每桶不到一项
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version         = VERSION;
+        header.count           = static_cast<uint32_t>(entries.size());
+        header.dictionaryCount = static_cast<uint32_t>(dictionaries.size());
+        while((size_t(1) << header.bucketBits) < entries.size())
+        {
+            header.bucketBits++;
+        }
+
+        std::vector<uint32_t> bucketTable((size_t(1) << header.bucketBits) + 1);
+        for(size_t bucket = 0, i = 0; bucket < bucketTable.size(); bucket++)
+        {
+            while(i < order.size() && Private::BucketOf(order[i].first, header.bucketBits) < bucket)
+            {
+                i++;
+            }
+            bucketTable[bucket] = static_cast<uint32_t>(i);
+        }
+
+        std::vector<DictionaryEntry> dictionaryTable;
+        for(auto& [name, meta] : dictionaries)
+        {
+            dictionaryTable.push_back(
+                { meta.offset, meta.size, intern(name), static_cast<uint32_t>(name.size()) });
+        }
+        std::vector<Entry> entryTable;
+        for(auto& [hash, i] : order)
+        {
+            auto& [uri, meta] = entries[i];
+            entryTable.push_back({ hash,
+                meta.offset,
+                meta.size,
+                intern(uri),
+                static_cast<uint32_t>(uri.size()),
+                meta.dictionary,
+                (meta.seekable ? SEEKABLE : 0) | (meta.stored ? STORED : 0) });
+        }
+
+        std::vector<uint8_t> index(sizeof(Header) + dictionaryTable.size() * sizeof(DictionaryEntry)
+                                   + bucketTable.size() * sizeof(uint32_t) + entryTable.size() * sizeof(Entry));
+        uint8_t*             out = index.data();
+        std::memcpy(out, &header, sizeof(Header));
+        out += sizeof(Header);
+        std::memcpy(out, dictionaryTable.data(), dictionaryTable.size() * sizeof(DictionaryEntry));
+        out += dictionaryTable.size() * sizeof(DictionaryEntry);
+        std::memcpy(out, bucketTable.data(), bucketTable.size() * sizeof(uint32_t));
+        out += bucketTable.size() * sizeof(uint32_t);
+        std::memcpy(out, entryTable.data(), entryTable.size() * sizeof(Entry));
+        index.insert(index.end(), pool.begin(), pool.end());
+
+        if(index.size() > UINT32_MAX)
+            throw std::runtime_error("Asset index too large");
+        auto size = static_cast<uint32_t>(index.size());
+        for(int i = 0; i < 4; i++)
+        {
+            index.push_back(static_cast<uint8_t>(size >> (8 * i)));
+        }
+        index.insert(index.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        return index;
+    }
+
+    BinaryData AssetIndex::Locate(BinaryData pack)
+    {
+        if(!Has(pack))
+            return {};
+        uint32_t indexSize = 0;
+        std::memcpy(&indexSize, pack.data() + pack.size() - FOOTERSIZE, sizeof(indexSize));
+        if(indexSize < sizeof(Header) || indexSize > pack.size() - FOOTERSIZE)
+            return {};
+        return pack.subspan(pack.size() - FOOTERSIZE - indexSize);
+    }
+
+    AssetIndex::AssetIndex(BinaryData pack) : pack(pack)
+    {
+        if(!Has(pack))
+            throw std::runtime_error("Invalid asset index");
+
+        BinaryData index = Locate(pack);
+        if(index.empty())
+            throw std::runtime_error("Invalid asset index size");
+        index = index.first(index.size() - FOOTERSIZE);
+        Header     header;
+        std::memcpy(&header, index.data(), sizeof(Header));
+        if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION)
+            throw std::runtime_error("Unsupported asset index version");
+        if(header.bucketBits > 32)
+            throw std::runtime_error("Invalid asset index buckets");
+
+        uint64_t buckets = (uint64_t(1) << header.bucketBits) + 1;
+        uint64_t tables  = sizeof(Header) + uint64_t(header.dictionaryCount) * sizeof(DictionaryEntry)
+                          + buckets * sizeof(uint32_t) + uint64_t(header.count) * sizeof(Entry);
+        if(tables > index.size())
+            throw std::runtime_error("Invalid asset index size");
+
+        count           = header.count;
+        dictionaryCount = header.dictionaryCount;
+        bucketBits      = header.bucketBits;
+        dictionaryTable = index.subspan(sizeof(Header), dictionaryCount * sizeof(DictionaryEntry));
+        bucketTable     = index.subspan(sizeof(Header) + dictionaryTable.size(), buckets * sizeof(uint32_t));
+        entryTable = index.subspan(sizeof(Header) + dictionaryTable.size() + bucketTable.size(), count * sizeof(Entry));
+        strings    = index.subspan(tables);
+    }
+
+    AssetIndex::Entry AssetIndex::GetEntry(size_t index) const
+    {
+        // 表在包内不一定对齐，逐条复制出来
+        Entry entry;
+        std::memcpy(&entry, entryTable.data() + index * sizeof(Entry), sizeof(Entry));
+        return entry;
+    }
+
+    uint64_t AssetIndex::GetHash(size_t index) const
+    {
+        uint64_t hash;
+        std::memcpy(&hash, entryTable.data() + index * sizeof(Entry), sizeof(hash));
+        return hash;
+    }
+
+    uint32_t AssetIndex::GetBucket(size_t index) const
+    {
+        uint32_t bucket;
+        std::memcpy(&bucket, bucketTable.data() + index * sizeof(bucket), sizeof(bucket));
+        return std::min(bucket, count);
+    }
+
+    std::string_view AssetIndex::GetString(uint32_t offset, uint32_t length) const
+    {
+        if(offset > strings.size() || length > strings.size() - offset)
+            throw std::runtime_error("Invalid asset index string");
+        return std::string_view(reinterpret_cast<const char*>(strings.data()) + offset, length);
+    }
+
+    AssetMeta AssetIndex::GetRange(uint64_t offset, uint64_t size) const
+    {
+        if(offset > pack.size() || size > pack.size() - offset)
+            throw std::runtime_error("Invalid asset range");
+        return { static_cast<size_t>(offset), static_cast<size_t>(size) };
+    }
+
+    size_t AssetIndex::GetCount() const
+    {
+        return count;
+    }
+
+    std::string_view AssetIndex::GetUri(size_t index) const
+    {
+        Entry entry = GetEntry(index);
+        return GetString(entry.uri, entry.uriLength);
+    }
+
+    AssetMeta AssetIndex::GetMeta(size_t index) const
+    {
+        Entry entry = GetEntry(index);
+        if(entry.dictionary >= 0 && static_cast<uint32_t>(entry.dictionary) >= dictionaryCount)
+            throw std::runtime_error("Unknown asset dictionary");
+        AssetMeta meta  = GetRange(entry.offset, entry.size);
+        meta.dictionary = entry.dictionary;
+        meta.seekable   = entry.flags & SEEKABLE;
+        meta.stored     = entry.flags & STORED;
+        return meta;
+    }
+
+    std::optional<AssetMeta> AssetIndex::Find(std::string_view uri) const
+    {
+        uint64_t hash   = Hash(uri);
+        size_t   bucket = Private::BucketOf(hash, bucketBits);
+        for(size_t i = GetBucket(bucket), end = GetBucket(bucket + 1); i < end; i++)
+        {
+            if(GetHash(i) == hash && GetUri(i) == uri)
+                return GetMeta(i);
+        }
+        return std::nullopt;
+    }
+
+    size_t AssetIndex::GetDictionaryCount() const
+    {
+        return dictionaryCount;
+    }
+
+    std::string_view AssetIndex::GetDictionaryName(size_t index) const
+    {
+        DictionaryEntry entry;
+        std::memcpy(&entry, dictionaryTable.data() + index * sizeof(DictionaryEntry), sizeof(DictionaryEntry));
+        return GetString(entry.name, entry.nameLength);
+    }
+
+    BinaryData AssetIndex::GetDictionary(size_t index) const
+    {
+        DictionaryEntry entry;
+        std::memcpy(&entry, dictionaryTable.data() + index * sizeof(DictionaryEntry), sizeof(DictionaryEntry));
+        AssetMeta range = GetRange(entry.offset, entry.size);
+        return pack.subspan(range.offset, range.size);
+    }
+}
@@ -0,0 +1,239 @@
+#include "assetpack.hpp"
+#include "assetindex.hpp"
+#include "assetstream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <zstd.h>
+
+namespace ezi
+{
+    namespace Private
+    {
+        static constexpr size_t MANIFESTSIZEFLAG = 4;
+    }
+
+    void DictionaryDeleter::operator()(ZSTD_DDict* dictionary) const
+    {
+        ZSTD_freeDDict(dictionary);
+    }
+
+    DecompressPool::Lease::Lease(DecompressPool* pool, ZSTD_DCtx* context) : pool(pool), context(context)
+    {
+    }
+
+    DecompressPool::Lease::~Lease()
+    {
+        pool->Release(context);
+    }
+
+    ZSTD_DCtx* DecompressPool::Lease::Get() const
+    {
+        return context;
+    }
+
+    DecompressPool::DecompressPool(size_t limit) : limit(limit)
+    {
+        if(!this->limit)
+            this->limit = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    DecompressPool::~DecompressPool()
+    {
+        for(auto context : contexts)
+        {
+            ZSTD_freeDCtx(context);
+        }
+    }
+
+    DecompressPool::Lease DecompressPool::Acquire()
+    {
+        {
+            std::lock_guard lock(mutex);
+            if(!contexts.empty())
+            {
+                ZSTD_DCtx* context = contexts.back();
+                contexts.pop_back();
+                return Lease(this, context);
+            }
+        }
+        ZSTD_DCtx* context = ZSTD_createDCtx();
+        if(!context)
+            throw std::runtime_error("Failed to create zstd decompression context");
+        return Lease(this, context);
+    }
+
+    void DecompressPool::Release(ZSTD_DCtx* context)
+    {
+        {
+            std::lock_guard lock(mutex);
+            if(contexts.size() < limit)
+            {
+                contexts.push_back(context);
+                return;
+            }
+        }
+        ZSTD_freeDCtx(context);
+    }
+
+    AssetPack::AssetPack(BinaryData binary) : binary(binary)
+    {
+        if(!AssetIndex::Has(binary))
+        {
+            LoadManifest();
+            return;
+        }
+
+        index = std::make_shared<AssetIndex>(binary);
+        for(size_t i = 0; i < index->GetDictionaryCount(); i++)
+        {
+            BinaryData  data       = index->GetDictionary(i);
+            ZSTD_DDict* dictionary = ZSTD_createDDict(data.data(), data.size());
+            if(!dictionary)
+                throw std::runtime_error("Invalid asset dictionary: " + String(index->GetDictionaryName(i)));
+            dictionaries.emplace_back(dictionary);
+        }
+    }
+
+    void AssetPack::LoadManifest()
+    {
+        if(binary.size() < Private::MANIFESTSIZEFLAG)
+            throw std::runtime_error("Invalid asset pack size");
+
+        uint32_t manifestSize = 0;
+        std::memcpy(&manifestSize, binary.data() + binary.size() - Private::MANIFESTSIZEFLAG, sizeof(manifestSize));
+
+        if(manifestSize == 0 || manifestSize > binary.size() - Private::MANIFESTSIZEFLAG)
+            throw std::runtime_error("Invalid asset manifest size");
+
+        size_t               manifestOffset    = binary.size() - manifestSize - Private::MANIFESTSIZEFLAG;
+        std::vector<uint8_t> unZipManifestData = Decompress(binary.subspan(manifestOffset, manifestSize));
+
+        auto manifestJson = Json::parse(unZipManifestData.begin(), unZipManifestData.end());
+
+        // 字典在加载时解析一次，之后各次解压共用
+        std::unordered_map<String, int> dictionaryIds;
+        if(auto it = manifestJson.find(DICTIONARIES); it != manifestJson.end())
+        {
+            for(auto& [name, range] : it->items())
+            {
+                BinaryData  data       = GetRange(name, range);
+                ZSTD_DDict* dictionary = ZSTD_createDDict(data.data(), data.size());
+                if(!dictionary)
+                    throw std::runtime_error("Invalid asset dictionary: " + name);
+                dictionaryIds[name] = static_cast<int>(dictionaries.size());
+                dictionaries.emplace_back(dictionary);
+            }
+            manifestJson.erase(it);
+        }
+
+        for(auto& [key, value] : manifestJson.items())
+        {
+            BinaryData data = GetRange(key, value);
+            AssetMeta  meta = { static_cast<size_t>(data.data() - binary.data()), data.size() };
+            if(auto dictionary = value.find("dict"); dictionary != value.end())
+            {
+                auto it = dictionaryIds.find(dictionary->get<String>());
+                if(it == dictionaryIds.end())
+                    throw std::runtime_error("Unknown asset dictionary: " + dictionary->get<String>());
+                meta.dictionary = it->second;
+            }
+            // 较早写入的清单没有记录seekable，按末尾的跳转表判断
+            meta.seekable = value.contains("seekable") ? value["seekable"].get<bool>() : AssetStream::IsSeekable(data);
+            metas[key]    = meta;
+        }
+    }
+
+    BinaryData AssetPack::GetRange(const String& name, const Json& range) const
+    {
+        size_t offset = range.at("offset").get<size_t>();
+        size_t size   = range.at("size").get<size_t>();
+        if(offset > binary.size() || size > binary.size() - offset)
+            throw std::runtime_error("Invalid asset range: " + name);
+        return binary.subspan(offset, size);
+    }
+
+    std::optional<AssetMeta> AssetPack::Find(std::string_view uri) const
+    {
+        if(index)
+            return index->Find(uri);
+        auto it = metas.find(uri);
+        if(it == metas.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    bool AssetPack::Contains(std::string_view uri) const
+    {
+        return Find(uri).has_value();
+    }
+
+    std::vector<uint8_t> AssetPack::GetAssetData(std::string_view uri) const
+    {
+        auto meta = Find(uri);
+        if(!meta)
+            return {};
+        if(meta->stored)
+        {
+            BinaryData data = binary.subspan(meta->offset, meta->size);
+            return std::vector<uint8_t>(data.begin(), data.end());
+        }
+        if(meta->seekable)
+        {
+            AssetStream          stream(binary.subspan(meta->offset, meta->size), pool);
+            std::vector<uint8_t> content(stream.GetLength());
+            stream.Read(content.data(), content.size());
+            return content;
+        }
+        return Decompress(binary.subspan(meta->offset, meta->size), meta->dictionary);
+    }
+
+    std::vector<uint8_t> AssetPack::Decompress(BinaryData zipData, int dictionary) const
+    {
+        size_t unZipDataSize = ZSTD_getFrameContentSize(zipData.data(), zipData.size());
+        if(unZipDataSize == ZSTD_CONTENTSIZE_ERROR || unZipDataSize == ZSTD_CONTENTSIZE_UNKNOWN)
+        {
+            throw std::runtime_error("无法确定解压后的大小");
+        }
+        std::vector<uint8_t> unZipData(unZipDataSize);
+
+        auto   lease = pool->Acquire();
+        size_t result;
+        if(dictionary < 0)
+        {
+            result = ZSTD_decompressDCtx(
+                lease.Get(), unZipData.data(), unZipData.size(), zipData.data(), zipData.size());
+        }
+        else
+        {
+            result = ZSTD_decompress_usingDDict(lease.Get(),
+                unZipData.data(),
+                unZipData.size(),
+                zipData.data(),
+                zipData.size(),
+                dictionaries[dictionary].get());
+        }
+        if(ZSTD_isError(result))
+        {
+            throw std::runtime_error(ZSTD_getErrorName(result));
+        }
+        return unZipData;
+    }
+
+    std::unique_ptr<AssetStream> AssetPack::OpenStream(std::string_view uri) const
+    {
+        auto meta = Find(uri);
+        if(!meta || !meta->seekable)
+            return nullptr;
+        return std::make_unique<AssetStream>(binary.subspan(meta->offset, meta->size), pool);
+    }
+
+    BinaryData AssetPack::GetStored(std::string_view uri) const
+    {
+        auto meta = Find(uri);
+        if(!meta || !meta->stored)
+            return {};
+        return binary.subspan(meta->offset, meta->size);
+    }
+}
@@ -0,0 +1,171 @@
+#include "assetstream.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <zstd.h>
+
+namespace ezi
+{
+    namespace Private
+    {
+        static uint32_t ReadUint32(const uint8_t* data)
+        {
+            return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+
+        static bool ParseNumber(std::string_view text, uint64_t& value)
+        {
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return !text.empty() && error == std::errc() && end == text.data() + text.size();
+        }
+    }
+
+    bool AssetStream::IsSeekable(BinaryData data)
+    {
+        return data.size() >= FOOTERSIZE + 8 && Private::ReadUint32(data.data() + data.size() - 4) == SEEKABLEMAGIC;
+    }
+
+    AssetStream::AssetStream(BinaryData data, std::shared_ptr<DecompressPool> pool) : data(data), pool(std::move(pool))
+    {
+        if(!IsSeekable(data))
+            throw std::runtime_error("Asset is not seekable");
+
+        // 跳转表：跳过帧头(8) + 各帧{压缩大小, 原始大小} + 页脚{帧数(4), 描述符(1), 魔数(4)}
+        const uint8_t* footer     = data.data() + data.size() - FOOTERSIZE;
+        uint32_t       count      = Private::ReadUint32(footer);
+        uint8_t        descriptor = footer[4];
+        size_t         entrySize  = (descriptor & 0x80) ? 12 : 8;
+        if(static_cast<uint64_t>(count) * entrySize + FOOTERSIZE + 8 > data.size())
+            throw std::runtime_error("Invalid seek table");
+
+        const uint8_t* entry = footer - static_cast<uint64_t>(count) * entrySize;
+        if(Private::ReadUint32(entry - 8) != SKIPPABLEMAGIC)
+            throw std::runtime_error("Invalid seek table");
+
+        uint64_t compressedOffset = 0;
+        frames.reserve(count);
+        for(uint32_t i = 0; i < count; i++, entry += entrySize)
+        {
+            Frame frame = { compressedOffset, Private::ReadUint32(entry), length, Private::ReadUint32(entry + 4) };
+            compressedOffset += frame.compressedSize;
+            length += frame.size;
+            frames.push_back(frame);
+        }
+        if(compressedOffset > data.size() - (static_cast<uint64_t>(count) * entrySize + FOOTERSIZE + 8))
+            throw std::runtime_error("Invalid seek table");
+    }
+
+    const std::vector<uint8_t>& AssetStream::LoadFrame(size_t index)
+    {
+        if(buffered == index)
+            return buffer;
+
+        const Frame& frame = frames[index];
+        buffer.resize(frame.size);
+        auto   lease  = pool->Acquire();
+        size_t result = ZSTD_decompressDCtx(
+            lease.Get(), buffer.data(), buffer.size(), data.data() + frame.compressedOffset, frame.compressedSize);
+        if(ZSTD_isError(result))
+        {
+            buffered = SIZE_MAX;
+            throw std::runtime_error(ZSTD_getErrorName(result));
+        }
+        // 帧被截断或与跳转表不符时缓冲区有一部分未写入，不能当作内容返回
+        if(result != frame.size)
+        {
+            buffered = SIZE_MAX;
+            throw std::runtime_error("Asset frame size mismatch");
+        }
+        buffered = index;
+        return buffer;
+    }
+
+    uint64_t AssetStream::GetLength() const
+    {
+        return length;
+    }
+
+    uint64_t AssetStream::GetPosition() const
+    {
+        return position;
+    }
+
+    void AssetStream::Seek(uint64_t position)
+    {
+        this->position = std::min(position, length);
+    }
+
+    size_t AssetStream::Read(uint8_t* out, size_t size)
+    {
+        size_t read = ReadAt(position, out, size);
+        position += read;
+        return read;
+    }
+
+    size_t AssetStream::ReadAt(uint64_t offset, uint8_t* out, size_t size)
+    {
+        if(offset >= length)
+            return 0;
+        size = static_cast<size_t>(std::min<uint64_t>(size, length - offset));
+
+        // 找到包含offset的帧，之后依次读取
+        auto   it    = std::upper_bound(frames.begin(),
+            frames.end(),
+            offset,
+            [](uint64_t value, const Frame& frame) { return value < frame.offset; });
+        size_t index = static_cast<size_t>(it - frames.begin()) - 1;
+        size_t read  = 0;
+        while(read < size)
+        {
+            const Frame& frame  = frames[index];
+            auto&        bytes  = LoadFrame(index);
+            size_t       within = static_cast<size_t>(offset + read - frame.offset);
+            size_t       count  = std::min(size - read, frame.size - within);
+            std::memcpy(out + read, bytes.data() + within, count);
+            read += count;
+            index++;
+        }
+        return read;
+    }
+
+    RangeResult ParseByteRange(std::string_view header, uint64_t length, ByteRange& range)
+    {
+        constexpr std::string_view prefix = "bytes=";
+        if(!header.starts_with(prefix) || header.find(',') != std::string_view::npos)
+            return RangeResult::none;
+        header.remove_prefix(prefix.size());
+
+        size_t dash = header.find('-');
+        if(dash == std::string_view::npos)
+            return RangeResult::none;
+        std::string_view first = header.substr(0, dash);
+        std::string_view last  = header.substr(dash + 1);
+
+        uint64_t begin, end;
+        if(first.empty())
+        {
+            // 末尾的n个字节
+            if(!Private::ParseNumber(last, end))
+                return RangeResult::none;
+            if(end == 0 || length == 0)
+                return RangeResult::unsatisfiable;
+            range = { length - std::min(end, length), length };
+            return RangeResult::partial;
+        }
+
+        if(!Private::ParseNumber(first, begin))
+            return RangeResult::none;
+        if(last.empty())
+            end = length;
+        else if(!Private::ParseNumber(last, end) || end < begin)
+            return RangeResult::none;
+        else
+            end = std::min(end + 1, length);
+
+        if(begin >= length)
+            return RangeResult::unsatisfiable;
+        range = { begin, end };
+        return RangeResult::partial;
+    }
+}
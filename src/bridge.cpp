@@ -1,80 +1,1163 @@
 #include "bridge.hpp"
+#include <chrono>
 #include "print.hpp"
-#include "windowm.hpp"
-#include "terminal.hpp"
-#include "tray.hpp"
 
 #if OS(WINDOWS)
-    #include <wrl.h>
-using namespace Microsoft::WRL;
+    #include "resource.hpp"
+    #include "windowm.hpp"
+    #include "terminal.hpp"
+    #include "tray.hpp"
+
+    #define LOGTEXT(text) utf8ToGbk(text)
+#else
+    #define LOGTEXT(text) (text)
 #endif
 
 namespace ezi
 {
-    void Bridge::ExposeTo(View& view, WinId winId)
+    namespace Private
+    {
+        // future形式在工作线程上阻塞等待结果，等待期间占用一个工作线程
+        // 耗时较长或数量较多的等待应改用返回Task的形式，在协程中 co_await
+        static Task AwaitFuture(FutureFunction func, Object args)
+        {
+            co_return func(std::move(args)).get();
+        }
+
+        // 把较大的二进制值移入共享环形缓冲区，消息中只保留位置
+        // 缓冲区已满时保留原值，按消息格式内联发送
+        static void Offload(Json& node, SharedRing& ring, size_t threshold)
+        {
+            if(node.is_binary())
+            {
+                auto& bytes = node.get_binary();
+                if(bytes.size() < threshold)
+                    return;
+                auto slice = ring.Write(bytes);
+                if(!slice)
+                    return;
+                node = {
+                    { "$ring", slice->seq },
+                    { "offset", slice->offset },
+                    { "length", slice->length },
+                };
+                return;
+            }
+            if(node.is_structured())
+            {
+                for(auto& child : node)
+                {
+                    Offload(child, ring, threshold);
+                }
+            }
+        }
+    }
+
+    Bridge::Bridge()
+    {
+        // 内置函数，与具体的消息通道无关
+        Register(
+            "bridge.negotiate", [this](const CallContext& context, Object args) { return Negotiate(context, args); });
+        Register("bridge.ack", [this](const CallContext& context, Object args) { return Ack(context, args); });
+        Register("bridge.getQueueStats", [this](Object) { return GetQueueStats(); });
+        Register("bridge.getMetrics", [this](Object) { return GetMetrics(); });
+        Register("bridge.subscribe",
+            [this](const CallContext& context, Object args) { return Subscribe(context, args, true); });
+        Register("bridge.unsubscribe",
+            [this](const CallContext& context, Object args) { return Subscribe(context, args, false); });
+        Register("bridge.openRing", [this](const CallContext& context, Object) { return OpenRing(context); });
+        Register("bridge.release", [this](const CallContext& context, Object args) { return Release(context, args); });
+        Register("bridge.cancel", [this](const CallContext& context, Object args) { return Cancel(context, args); });
+    }
+
+#if OS(WINDOWS)
+    void Bridge::ExposeTo(View& view, WinId winId, WireFormat allowed)
     {
         static bool mounted = false;
         if(!mounted)
         {
             mounted = true;
+            SetWorkerCount(CFGRES<int>("bridge.workers", 0));
+            SetStreamWindow(CFGRES<int>("bridge.streamWindow", 8));
+            SetStreamWorkers(CFGRES<int>("bridge.streamWorkers", 2));
+            SetStreamTimeout(std::chrono::milliseconds(CFGRES<int>("bridge.streamTimeoutMs", 30000)));
+            SetQueueLimit(CFGRES<int>("bridge.queueLimit", 64));
+            SetEventFrame(std::chrono::milliseconds(CFGRES<int>("bridge.eventFrameMs", 16)));
+            SetRing(CFGRES<size_t>("bridge.ringCapacity", 8 << 20), CFGRES<size_t>("bridge.ringThreshold", 16 << 10));
+            if(auto record = CFGRES<String>("bridge.record", ""); !record.empty())
+                StartRecording(record);
+            // 配置中可以追加按帧合并的事件主题，如 {"bridge": {"coalesce": ["fs.progress"]}}
+            for(auto& topic : CFGRES<Json>("bridge.coalesce", Json::array()))
+            {
+                SetCoalesced(topic.get<String>(), true);
+            }
             windowm::Mount();
-#if BUILDTYPE(DEBUG)
+    #if BUILDTYPE(DEBUG)
             terminal::Mount();
-#endif
+    #endif
             tray::Mount();
+            Register("resource.getCacheStats", [](Object args) { return Resource::GetInstance().GetCacheStats(); });
+            // 配置中可以把函数标记为幂等，如 {"bridge": {"idempotent": {"fs.stat": {"ttlMs": 100, "invalidatedBy": ["fs.changed"]}}}}
+            for(auto& [name, memo] : CFGRES<Json>("bridge.idempotent", Json::object()).items())
+            {
+                SetIdempotent(name,
+                    std::chrono::milliseconds(memo.value("ttlMs", 250)),
+                    memo.value("invalidatedBy", std::vector<String>()));
+            }
+            // 配置中可以覆盖函数的优先级，如 {"bridge": {"priorities": {"fs.sync": "bulk"}}}
+            for(auto& [name, priority] : CFGRES<Json>("bridge.priorities", Json::object()).items())
+            {
+                SetPriority(name, ParsePriority(priority.get<String>()));
+            }
+            Freeze();
+        }
+
+        // 发布函数编号表，之后的调用可以直接使用编号
+        view->AddScriptToExecuteOnDocumentCreated(utf8ToUtf16(functionIdsScript).c_str(), nullptr);
+
+        Attach(winId, std::make_shared<WebViewTransport>(view, winId), allowed);
+    }
+#endif
+
+    void Bridge::Attach(WinId winId, std::shared_ptr<Transport> transport, WireFormat allowed)
+    {
+        transport->SetReceiver([this, winId](Payload payload, WireFormat format, Clock::time_point received)
+            { OnMessage(winId, std::move(payload), format, received); });
+
+        std::shared_ptr<Transport> previous;
+        {
+            std::lock_guard lock(channelMutex);
+            auto&           channel = channels[winId];
+            previous                = std::exchange(channel.transport, std::move(transport));
+            channel.allowed         = allowed;
+            channel.format          = WireFormat::json;
+        }
+        if(previous)
+            previous->Close();
+    }
+
+    void Bridge::Detach(WinId winId)
+    {
+        std::shared_ptr<Transport> transport;
+        {
+            std::lock_guard lock(channelMutex);
+            auto            it = channels.find(winId);
+            if(it == channels.end())
+                return;
+            transport = std::move(it->second.transport);
+            channels.erase(it);
         }
+        transport->Close();
+        // 结束消息已无处投递，不会再从表中移除这些流
+        CloseStreams(winId);
+    }
+
+    std::shared_ptr<Transport> Bridge::GetTransport(WinId winId)
+    {
+        std::lock_guard lock(channelMutex);
+        auto            it = channels.find(winId);
+        return it != channels.end() ? it->second.transport : nullptr;
+    }
 
-        view->add_WebMessageReceived(
-            Callback<ICoreWebView2WebMessageReceivedEventHandler>(
-                [this, winId](ICoreWebView2* sender, ICoreWebView2WebMessageReceivedEventArgs* args) -> HRESULT
+    void Bridge::OnMessage(WinId winId, Payload payload, WireFormat format, Clock::time_point received)
+    {
+        // 未协商为二进制的窗口不接受msgpack帧
+        if(format == WireFormat::msgpack)
+        {
+            bool negotiated;
+            {
+                std::lock_guard lock(channelMutex);
+                auto            it = channels.find(winId);
+                negotiated         = it != channels.end() && it->second.format == WireFormat::msgpack;
+            }
+            if(!negotiated)
+            {
+                RejectFormat(winId, std::move(payload));
+                return;
+            }
+        }
+
+        // 只解析信封，args留到处理函数读取时再解析
+        std::vector<Envelope> calls;
+        bool                  batch;
+        try
+        {
+            batch = Envelope::Open(payload, format, calls);
+        }
+        catch(const std::exception& e)
+        {
+            println("bridge message dropped:", e.what());
+            return;
+        }
+
+        // 消息级的解析、序列化和发送耗时平摊到消息中的各个函数
+        auto targets = CollectMetrics(calls);
+        auto parseNs = ElapsedNs(received);
+        for(auto& metrics : targets)
+        {
+            metrics->Record(Phase::parse, parseNs / targets.size());
+        }
+
+        // println在发布版中展开为空语句，分支需要加括号
+        if(format == WireFormat::json)
+        {
+            println("request:", LOGTEXT(*payload));
+        }
+        else
+        {
+            println("request:", payload->size(), "bytes msgpack");
+        }
+
+        auto send = [this, winId, format, targets](Json response)
+        {
+            auto timing = Send(winId, std::move(response), format);
+            for(auto& metrics : targets)
+            {
+                metrics->Record(Phase::serialize, timing.serializeNs / targets.size());
+                metrics->Record(Phase::post, timing.postNs / targets.size());
+            }
+        };
+        if(batch)
+        {
+            DispatchBatch(winId, calls, send);
+        }
+        else
+        {
+            Dispatch(winId, calls.front(), send);
+        }
+    }
+
+    void Bridge::RejectFormat(WinId winId, Payload payload)
+    {
+        // 以json回复，能解出id时带上id，页面的调用不会一直挂起
+        std::vector<Envelope> calls;
+        bool                  batch = false;
+        try
+        {
+            batch = Envelope::Open(payload, WireFormat::msgpack, calls);
+        }
+        catch(const std::exception& e)
+        {
+            println("bridge msgpack frame before negotiation:", e.what());
+        }
+
+        Json error     = BridgeError("unsupported_format", "msgpack has not been negotiated").ToJson();
+        Json responses = Json::array();
+        for(auto& call : calls)
+        {
+            responses.push_back({
+                { "id", call.GetId() },
+                { "result", error },
+            });
+        }
+        if(batch)
+            Send(winId, std::move(responses), WireFormat::json);
+        else if(!responses.empty())
+            Send(winId, std::move(responses.front()), WireFormat::json);
+        else
+            Send(winId, { { "id", nullptr }, { "result", error } }, WireFormat::json);
+    }
+
+    void Bridge::Dispatch(WinId winId, Envelope& envelope, Reply reply)
+    {
+        const Json& id   = envelope.GetId();
+        const Json& func = envelope.GetFunc();
+
+        const FunctionEntry* entry = Find(func);
+        if(!entry)
+        {
+            // 名字原样给出，编号给出数字
+            String name = func.is_string() ? func.get<String>() : func.is_null() ? "" : func.dump();
+            reply({
+                { "id", id },
+                { "result", BridgeError("not_found", "Function not found: " + name).ToJson() },
+            });
+            return;
+        }
+
+        entry->metrics->calls.fetch_add(1, std::memory_order_relaxed);
+
+        if(recorder.IsRecording())
+        {
+            recorder.Record(entry->name,
+                std::to_string(reinterpret_cast<uintptr_t>(winId)),
+                envelope.GetFormat(),
+                envelope.GetRawArgs());
+        }
+
+        if(entry->stream || entry->async)
+        {
+            // 异步和流式函数的参数需要移交给工作线程
+            Json args;
+            try
+            {
+                args = envelope.TakeArgs();
+            }
+            catch(const BridgeError& e)
+            {
+                entry->metrics->errors.fetch_add(1, std::memory_order_relaxed);
+                reply({
+                    { "id", id },
+                    { "result", e.ToJson() },
+                });
+                return;
+            }
+
+            // 页面可以通过 bridge.cancel {id} 取消
+            CallContext context { winId, Track(winId, id) };
+            if(entry->stream)
+            {
+                InvokeStream(context, *entry, id, std::move(args), std::move(reply));
+                return;
+            }
+
+            // 在工作线程执行，结果回到窗口线程后再发送
+            InvokeAsync(context,
+                *entry,
+                std::move(args),
+                [this, winId, id, reply](Json result)
                 {
-                    wil::unique_cotaskmem_string _message;
-                    args->get_WebMessageAsJson(&_message);
-                    std::wstring message(_message.get());
+                    PostToWindow(winId,
+                        [this, winId, id, reply, result = std::move(result)]
+                        {
+                            Untrack(winId, id);
+                            reply({
+                                { "id", id },
+                                { "result", result },
+                            });
+                        });
+                });
+            return;
+        }
 
-                    Json request                   = Json::parse(utf16ToUtf8(message));
-                    request["args"]["senderWinId"] = std::to_string(reinterpret_cast<uintptr_t>(winId));
-                    println("request:", utf8ToGbk(request.dump()));
+        // 同步调用在窗口线程上执行完毕，不登记取消令牌
+        CallContext context { winId, {} };
+        Json        result;
+        auto        started = Clock::now();
+        try
+        {
+            result = Invoke(*entry, context, envelope);
+        }
+        catch(const BridgeError& e)
+        {
+            result = e.ToJson();
+            entry->metrics->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        catch(const std::exception& e)
+        {
+            result = { { "error", e.what() } };
+            entry->metrics->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        entry->metrics->Record(Phase::dispatch, ElapsedNs(started));
+
+        reply({
+            { "id", id },
+            { "result", result },
+        });
+    }
 
+    void Bridge::DispatchBatch(WinId winId, std::vector<Envelope>& calls, Reply reply)
+    {
+        // 按顺序派发，全部完成后以一个数组回复
+        struct Batch
+        {
+            Json   responses;
+            size_t remaining;
+            Reply  reply;
+        };
+
+        if(calls.empty())
+        {
+            reply(Json::array());
+            return;
+        }
+
+        auto batch = std::make_shared<Batch>(Batch { Json::array(), calls.size(), std::move(reply) });
+        batch->responses.get_ref<Json::array_t&>().resize(calls.size());
+
+        for(size_t i = 0; i < calls.size(); i++)
+        {
+            Dispatch(winId,
+                calls[i],
+                [batch, i](Json response)
+                {
+                    batch->responses[i] = std::move(response);
+                    if(--batch->remaining == 0)
+                        batch->reply(std::move(batch->responses));
+                });
+        }
+    }
+
+    SendTiming Bridge::Send(WinId winId, Json message, WireFormat format)
+    {
+        auto transport = GetTransport(winId);
+        if(!transport)
+            return {};
+
+        if(auto ring = transport->GetRing())
+            Private::Offload(message, *ring, ringThreshold);
+
+        println("response:", LOGTEXT(message.dump()));
+
+        return transport->Send(message, format);
+    }
+
+    MetricsList Bridge::CollectMetrics(const std::vector<Envelope>& calls) const
+    {
+        MetricsList targets;
+        for(auto& call : calls)
+        {
+            if(auto entry = Find(call.GetFunc()))
+                targets.push_back(entry->metrics);
+        }
+        return targets;
+    }
+
+    Json Bridge::GetMetrics() const
+    {
+        Json result = Json::object();
+        for(auto& entry : functions)
+        {
+            if(entry.metrics->calls.load(std::memory_order_relaxed) > 0)
+                result[entry.name] = entry.metrics->ToJson();
+        }
+        return result;
+    }
+
+    Object Bridge::Negotiate(const CallContext& context, Object args)
+    {
+        std::lock_guard lock(channelMutex);
+        auto&           channel = channels.at(context.sender);
+
+        // 按页面给出的顺序选择第一个本窗口允许的格式
+        channel.format = WireFormat::json;
+        for(auto& name : args.value("formats", Array {}))
+        {
+            if(!name.is_string())
+                continue;
+            auto format = ParseWireFormat(name.get<String>());
+            if(format <= channel.allowed)
+            {
+                channel.format = format;
+                break;
+            }
+        }
+        return { { "format", channel.format == WireFormat::msgpack ? "msgpack" : "json" } };
+    }
+
+    WireFormat Bridge::ParseWireFormat(const String& name)
+    {
+        if(name == "msgpack")
+            return WireFormat::msgpack;
+        return WireFormat::json;
+    }
+
+    Json Bridge::Call(const String& func, const Json& args, const CallContext& context)
+    {
+        const FunctionEntry* entry = Find(func);
+        if(!entry)
+            throw BridgeError("not_found", "Function not found: " + func);
+        Envelope envelope(args);
+        return Invoke(*entry, context, envelope);
+    }
+
+    void Bridge::CallAsync(const String& func, Json args, Reply reply)
+    {
+        const FunctionEntry* entry = Find(func);
+        if(!entry || !entry->async)
+        {
+            reply(BridgeError("not_found", "Function not found: " + func).ToJson());
+            return;
+        }
+        InvokeAsync({}, *entry, std::move(args), std::move(reply));
+    }
+
+    uint64_t Bridge::CallStream(const String& func, Json args)
+    {
+        const FunctionEntry* entry = Find(func);
+        if(!entry || !entry->stream)
+            throw BridgeError("not_found", "Function not found: " + func);
+        ResponseStream stream(1, [&stream](uint64_t, Json) { stream.Ack(1); });
+        entry->stream(std::move(args), stream);
+        return stream.GetSequence();
+    }
+
+    Json Bridge::Invoke(const FunctionEntry& entry, const CallContext& context, Envelope& envelope)
+    {
+        if(!entry.handler)
+            throw BridgeError("not_found", "Function not found: " + entry.name);
+        if(entry.memoTtl <= std::chrono::milliseconds::zero())
+            return entry.handler(context, envelope);
+
+        // 以原始参数字节为键，命中时不必解析参数
+        std::string_view raw = envelope.GetRawArgs();
+        std::string      key = envelope.GetFormat() == WireFormat::msgpack ? "m" : "j";
+        if(raw.empty())
+            key += envelope.GetArgs().dump();
+        else
+            key += raw;
+
+        auto compute = [&entry, &context, &envelope] { return entry.handler(context, envelope); };
+        bool hit     = false;
+        Json result  = memo.Get(entry.name, key, entry.memoTtl, compute, hit);
+        if(hit)
+            entry.metrics->memoHits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void Bridge::InvokeAsync(const CallContext& context, const FunctionEntry& entry, Json args, Reply reply)
+    {
+        // 排队中的任务持有协程帧，线程池丢弃未执行的任务时随之释放；开始执行后由完成回调持有
+        std::shared_ptr<Task> task;
+        try
+        {
+            task = std::make_shared<Task>(entry.async(context, std::move(args)));
+        }
+        catch(const std::exception& e)
+        {
+            reply({ { "error", e.what() } });
+            return;
+        }
+        catch(...)
+        {
+            reply(BridgeError("internal", "Unknown error").ToJson());
+            return;
+        }
+
+        auto job = [task, reply, metrics = entry.metrics, token = context.token]() mutable
+        {
+            // 排队期间已被取消的调用不再执行
+            if(token.IsCancelled())
+            {
+                reply(BridgeError("cancelled", "Call cancelled").ToJson());
+                return;
+            }
+            task->Start(
+                [task, reply = std::move(reply), metrics, started = Clock::now()]
+                {
                     Json result;
                     try
                     {
-                        result = Call(request["func"], request["args"]);
+                        result = task->TakeResult();
+                    }
+                    catch(const BridgeError& e)
+                    {
+                        result = e.ToJson();
+                        metrics->errors.fetch_add(1, std::memory_order_relaxed);
                     }
                     catch(const std::exception& e)
                     {
                         result = { { "error", e.what() } };
+                        metrics->errors.fetch_add(1, std::memory_order_relaxed);
                     }
+                    catch(...)
+                    {
+                        // 在协程的最终挂起点中执行，异常不能再向外抛出
+                        result = BridgeError("internal", "Unknown error").ToJson();
+                        metrics->errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    metrics->Record(Phase::dispatch, ElapsedNs(started));
+                    reply(std::move(result));
+                });
+        };
+
+        if(!Enqueue(GetWorkers(), context.sender, entry.priority, std::move(job)))
+            reply(BridgeError("backpressure", "Bridge queue is full").ToJson());
+    }
+
+    void Bridge::InvokeStream(const CallContext& context, const FunctionEntry& entry, Json id, Json args, Reply reply)
+    {
+        WinId winId  = context.sender;
+        auto  stream = std::make_shared<ResponseStream>(streamWindow,
+            [this, winId, id](uint64_t seq, Json chunk)
+            {
+                PostToWindow(winId,
+                    [this, winId, id, seq, chunk = std::move(chunk)]
+                    {
+                        WireFormat format;
+                        {
+                            std::lock_guard lock(channelMutex);
+                            auto            it = channels.find(winId);
+                            if(it == channels.end())
+                                return;
+                            format = it->second.format;
+                        }
+                        Send(winId,
+                            {
+                                { "id", id },
+                                { "seq", seq },
+                                { "chunk", chunk },
+                            },
+                            format);
+                    });
+            },
+            streamTimeout);
+        {
+            std::lock_guard lock(streamMutex);
+            streams[winId][id.dump()] = stream;
+        }
+
+        // 取消时关闭流，阻塞中的Write随即返回false
+        context.token.OnCancel([stream] { stream->Close(); });
+
+        auto job = [this,
+                       winId,
+                       id,
+                       stream,
+                       token   = context.token,
+                       func    = entry.stream,
+                       metrics = entry.metrics,
+                       args    = std::move(args),
+                       reply]() mutable
+        {
+            Json result;
+            auto started = Clock::now();
+            try
+            {
+                token.ThrowIfCancelled();
+                func(std::move(args), *stream);
+                token.ThrowIfCancelled();
+                if(stream->IsTimedOut())
+                    throw BridgeError("timeout", "Stream consumer stopped acknowledging");
+            }
+            catch(const BridgeError& e)
+            {
+                result = e.ToJson();
+                metrics->errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            catch(const std::exception& e)
+            {
+                result = { { "error", e.what() } };
+                metrics->errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            catch(...)
+            {
+                result = BridgeError("internal", "Unknown error").ToJson();
+                metrics->errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            metrics->Record(Phase::dispatch, ElapsedNs(started));
 
-                    Json response = {
-                        { "id", request["id"] },
+            // 与数据块走同一队列，保证结束消息在所有数据块之后
+            PostToWindow(winId,
+                [this, winId, id, seq = stream->GetSequence(), result, reply]
+                {
+                    EraseStream(winId, id);
+                    Untrack(winId, id);
+                    reply({
+                        { "id", id },
+                        { "seq", seq },
+                        { "done", true },
                         { "result", result },
-                    };
+                    });
+                });
+        };
 
-                    auto utf8Response = response.dump();
-                    println("response:", utf8ToGbk(utf8Response));
+        if(!Enqueue(GetStreamWorkers(), winId, entry.priority, std::move(job)))
+        {
+            EraseStream(winId, id);
+            Untrack(winId, id);
+            reply({
+                { "id", id },
+                { "result", BridgeError("backpressure", "Bridge queue is full").ToJson() },
+            });
+        }
+    }
 
-                    sender->PostWebMessageAsJson(utf8ToUtf16(utf8Response).c_str());
-                    return S_OK;
-                })
-                .Get(),
-            nullptr);
+    void Bridge::EraseStream(WinId winId, const Json& id)
+    {
+        std::lock_guard lock(streamMutex);
+        auto            it = streams.find(winId);
+        if(it == streams.end())
+            return;
+        it->second.erase(id.dump());
+        if(it->second.empty())
+            streams.erase(it);
     }
 
-    Json Bridge::Call(String func, Json args)
+    void Bridge::CloseStreams(WinId winId)
     {
-        auto it = functions.find(func);
-        Json result;
-        if(it != functions.end() && it->second)
+        std::unordered_map<String, std::shared_ptr<ResponseStream>> closing;
+        {
+            std::lock_guard lock(streamMutex);
+            auto            it = streams.find(winId);
+            if(it == streams.end())
+                return;
+            closing.swap(it->second);
+            streams.erase(it);
+        }
+        // 阻塞中的Write随即返回false
+        for(auto& [id, stream] : closing)
         {
-            result = it->second(args);
+            stream->Close();
         }
+    }
+
+    bool Bridge::Enqueue(WorkerPool& pool, WinId winId, Priority priority, Job job)
+    {
+        auto queued = std::chrono::steady_clock::now();
+        {
+            std::lock_guard lock(queueMutex);
+            auto&           stats = queueStats[static_cast<size_t>(priority)];
+            auto            depth = queueDepths.find(winId);
+            // 每个窗口排队中的请求数有上限，超出时让页面自行退避
+            if(winId && (depth != queueDepths.end() ? depth->second : 0) >= queueLimit)
+            {
+                stats.rejected++;
+                return false;
+            }
+            queueDepths[winId]++;
+            stats.submitted++;
+            stats.depth++;
+            if(stats.depth > stats.maxDepth)
+                stats.maxDepth = stats.depth;
+        }
+
+        pool.Submit(
+            [this, winId, priority, queued, job = std::move(job)]
+            {
+                double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queued)
+                                    .count();
+                {
+                    std::lock_guard lock(queueMutex);
+                    auto&           stats = queueStats[static_cast<size_t>(priority)];
+                    // 没有排队请求的窗口不再保留，已关闭的窗口不会一直留在表中
+                    if(auto it = queueDepths.find(winId); it != queueDepths.end() && --it->second == 0)
+                        queueDepths.erase(it);
+                    stats.depth--;
+                    stats.totalWaitMs += waited;
+                    if(waited > stats.maxWaitMs)
+                        stats.maxWaitMs = waited;
+                }
+                job();
+            },
+            priority);
+        return true;
+    }
+
+    Json Bridge::GetQueueStats()
+    {
+        static const char* names[] = { "interactive", "normal", "bulk" };
+
+        std::lock_guard lock(queueMutex);
+
+        Json windows = Json::object();
+        for(auto& [winId, depth] : queueDepths)
+        {
+            windows[std::to_string(reinterpret_cast<uintptr_t>(winId))] = depth;
+        }
+
+        Json priorities = Json::object();
+        for(size_t i = 0; i < queueStats.size(); i++)
+        {
+            auto&  stats   = queueStats[i];
+            size_t started = stats.submitted - stats.depth;
+            priorities[names[i]] = {
+                { "submitted", stats.submitted },
+                { "rejected", stats.rejected },
+                { "depth", stats.depth },
+                { "maxDepth", stats.maxDepth },
+                { "avgWaitMs", started ? stats.totalWaitMs / started : 0.0 },
+                { "maxWaitMs", stats.maxWaitMs },
+            };
+        }
+
+        return {
+            { "limit", queueLimit },
+            { "windows", windows },
+            { "priorities", priorities },
+        };
+    }
+
+    Priority Bridge::ParsePriority(const String& name)
+    {
+        if(name == "interactive")
+            return Priority::interactive;
+        if(name == "bulk")
+            return Priority::bulk;
+        return Priority::normal;
+    }
+
+    void Bridge::SetPriority(const String& name, Priority priority)
+    {
+        Intern(name).priority = priority;
+    }
+
+    void Bridge::SetIdempotent(const String& name,
+        std::chrono::milliseconds  ttl,
+        const std::vector<String>& invalidatedBy)
+    {
+        auto& entry = Intern(name);
+        if(entry.async || entry.stream)
+            throw std::runtime_error("Only synchronous functions can be idempotent: " + name);
+        entry.memoTtl = ttl;
+        memo.SetTopics(name, invalidatedBy);
+    }
+
+    void Bridge::SetQueueLimit(size_t limit)
+    {
+        queueLimit = limit;
+    }
+
+    Object Bridge::Ack(const CallContext& context, Object args)
+    {
+        std::shared_ptr<ResponseStream> stream;
+        {
+            std::lock_guard lock(streamMutex);
+            auto            it = streams.find(context.sender);
+            if(it == streams.end())
+                return false;
+            auto call = it->second.find(args.value("id", Json()).dump());
+            if(call == it->second.end())
+                return false;
+            stream = call->second;
+        }
+        stream->Ack(args.value("count", 1));
+        return true;
+    }
+
+    Object Bridge::Subscribe(const CallContext& context, Object args, bool subscribe)
+    {
+        std::lock_guard lock(channelMutex);
+        auto&           channel = channels.at(context.sender);
+        for(auto& topic : args.value("topics", Array {}))
+        {
+            if(!topic.is_string())
+                continue;
+            if(subscribe)
+            {
+                channel.topics.insert(topic.get<String>());
+            }
+            else
+            {
+                channel.topics.erase(topic.get<String>());
+                channel.coalesced.erase(topic.get<String>());
+            }
+        }
+        return Array(channel.topics.begin(), channel.topics.end());
+    }
+
+    void Bridge::Emit(const String& topic, Json payload, WinId target)
+    {
+        // 缓存立即失效，不等合并的事件发出
+        memo.Invalidate(topic);
+
+        std::vector<std::pair<WinId, std::shared_ptr<Transport>>> immediate;
+        std::vector<std::pair<WinId, std::shared_ptr<Transport>>> scheduled;
+        {
+            std::lock_guard lock(channelMutex);
+            bool            coalesce = coalescedTopics.contains(topic);
+            for(auto& [winId, channel] : channels)
+            {
+                if((target && winId != target) || !channel.topics.contains(topic))
+                    continue;
+                if(!coalesce)
+                {
+                    immediate.emplace_back(winId, channel.transport);
+                    continue;
+                }
+                // 同一帧内的事件只保留最新值，帧末统一发送
+                channel.coalesced[topic] = payload;
+                if(!channel.flushing)
+                {
+                    channel.flushing = true;
+                    scheduled.emplace_back(winId, channel.transport);
+                }
+            }
+        }
+
+        if(!immediate.empty())
+        {
+            Json events = Json::array({ {
+                { "topic", topic },
+                { "payload", std::move(payload) },
+            } });
+            for(auto& [winId, transport] : immediate)
+            {
+                transport->Post([this, winId, events] { SendEvents(winId, events); });
+            }
+        }
+        for(auto& [winId, transport] : scheduled)
+        {
+            transport->PostDelayed([this, winId] { FlushEvents(winId); }, eventFrame);
+        }
+    }
+
+    void Bridge::FlushEvents(WinId winId)
+    {
+        Json coalesced;
+        {
+            std::lock_guard lock(channelMutex);
+            auto            it = channels.find(winId);
+            if(it == channels.end())
+                return;
+            coalesced           = std::exchange(it->second.coalesced, Json::object());
+            it->second.flushing = false;
+        }
+
+        Json events = Json::array();
+        for(auto& [topic, payload] : coalesced.items())
+        {
+            events.push_back({
+                { "topic", topic },
+                { "payload", std::move(payload) },
+            });
+        }
+        if(!events.empty())
+            SendEvents(winId, std::move(events));
+    }
+
+    void Bridge::SendEvents(WinId winId, Json events)
+    {
+        WireFormat format;
+        {
+            std::lock_guard lock(channelMutex);
+            auto            it = channels.find(winId);
+            if(it == channels.end())
+                return;
+            format = it->second.format;
+        }
+        // 事件没有id，页面按events字段与调用结果区分
+        Send(winId, { { "events", std::move(events) } }, format);
+    }
+
+    Object Bridge::OpenRing(const CallContext& context)
+    {
+        auto transport = GetTransport(context.sender);
+        if(!transport || !transport->OpenRing(ringCapacity))
+            return false;
+        return {
+            { "capacity", transport->GetRing()->GetCapacity() },
+            { "threshold", ringThreshold },
+        };
+    }
+
+    Object Bridge::Release(const CallContext& context, Object args)
+    {
+        auto transport = GetTransport(context.sender);
+        auto ring      = transport ? transport->GetRing() : nullptr;
+        if(!ring)
+            return false;
+        // 页面可以一次释放多段
+        for(auto& seq : args.value("seqs", Array {}))
+        {
+            if(seq.is_number_unsigned())
+                ring->Release(seq.get<uint64_t>());
+        }
+        return true;
+    }
+
+    CancellationToken Bridge::Track(WinId winId, const Json& id)
+    {
+        auto            token = CancellationToken::Create();
+        std::lock_guard lock(inflightMutex);
+        inflight[winId][id.dump()] = token;
+        return token;
+    }
+
+    void Bridge::Untrack(WinId winId, const Json& id)
+    {
+        std::lock_guard lock(inflightMutex);
+        auto            it = inflight.find(winId);
+        if(it == inflight.end())
+            return;
+        it->second.erase(id.dump());
+        if(it->second.empty())
+            inflight.erase(it);
+    }
+
+    Object Bridge::Cancel(const CallContext& context, Object args)
+    {
+        CancellationToken token;
+        {
+            std::lock_guard lock(inflightMutex);
+            auto            it = inflight.find(context.sender);
+            if(it == inflight.end())
+                return false;
+            auto call = it->second.find(args.value("id", Json()).dump());
+            if(call == it->second.end())
+                return false;
+            token = std::move(call->second);
+            it->second.erase(call);
+        }
+        token.Cancel();
+        return true;
+    }
+
+    void Bridge::CancelWindow(WinId winId)
+    {
+        std::unordered_map<String, CancellationToken> calls;
+        {
+            std::lock_guard lock(inflightMutex);
+            auto            it = inflight.find(winId);
+            if(it != inflight.end())
+            {
+                calls.swap(it->second);
+                inflight.erase(it);
+            }
+        }
+        for(auto& [id, token] : calls)
+        {
+            token.Cancel();
+        }
+        // 页面已离开，结束消息可能不会再投递
+        CloseStreams(winId);
+    }
+
+    bool Bridge::StartRecording(const String& path)
+    {
+        return recorder.Start(path);
+    }
+
+    void Bridge::StopRecording()
+    {
+        recorder.Stop();
+    }
+
+    void Bridge::SetRing(size_t capacity, size_t threshold)
+    {
+        ringCapacity  = capacity;
+        ringThreshold = threshold;
+    }
+
+    void Bridge::SetCoalesced(const String& topic, bool coalesced)
+    {
+        std::lock_guard lock(channelMutex);
+        if(coalesced)
+            coalescedTopics.insert(topic);
         else
+            coalescedTopics.erase(topic);
+    }
+
+    void Bridge::SetEventFrame(std::chrono::milliseconds frame)
+    {
+        eventFrame = frame;
+    }
+
+    FunctionEntry& Bridge::Intern(String name)
+    {
+        // 冻结后窗口已开始调用，修改函数表会使进行中的调用持有的表项失效
+        if(frozen)
+            throw std::runtime_error("Bridge functions are frozen: " + name);
+
+        auto it = functionIds.find(name);
+        if(it != functionIds.end())
+            return functions[it->second];
+
+        FunctionId id = static_cast<FunctionId>(functions.size());
+        functionIds.emplace(name, id);
+        auto& entry = functions.emplace_back();
+        entry.name  = std::move(name);
+        return entry;
+    }
+
+    const FunctionEntry* Bridge::Find(const Json& func) const
+    {
+        // 数字为编号，直接查表；字符串走名字查找
+        if(func.is_number_unsigned())
         {
-            throw std::runtime_error("Function not found: " + func);
+            auto id = func.get<uint64_t>();
+            return id < functions.size() ? &functions[id] : nullptr;
         }
+        if(func.is_string())
+            return Find(func.get_ref<const String&>());
+        return nullptr;
+    }
 
-        return result;
+    const FunctionEntry* Bridge::Find(const String& name) const
+    {
+        auto it = functionIds.find(name);
+        return it != functionIds.end() ? &functions[it->second] : nullptr;
+    }
+
+    void Bridge::Freeze()
+    {
+        // 挂载完成后的函数表即为发布给页面的编号表，之后不能再注册或修改函数
+        frozen            = true;
+        functionIdsScript = "window.__EziBridgeFunctions=Object.freeze(" + GetFunctionIds().dump() + ");";
+    }
+
+    Json Bridge::GetFunctionIds() const
+    {
+        Json ids = Json::object();
+        for(auto& [name, id] : functionIds)
+        {
+            ids[name] = id;
+        }
+        return ids;
+    }
+
+    FunctionId Bridge::GetFunctionId(const String& name) const
+    {
+        auto it = functionIds.find(name);
+        if(it == functionIds.end())
+            throw BridgeError("not_found", "Function not found: " + name);
+        return it->second;
+    }
+
+    bool Bridge::IsAsync(const String& name) const
+    {
+        auto entry = Find(name);
+        return entry && entry->async;
+    }
+
+    bool Bridge::IsStream(const String& name) const
+    {
+        auto entry = Find(name);
+        return entry && entry->stream;
+    }
+
+    WorkerPool& Bridge::GetStreamWorkers()
+    {
+        if(!streamWorkers)
+            streamWorkers = std::make_unique<WorkerPool>(streamWorkerCount);
+        return *streamWorkers;
+    }
+
+    WorkerPool& Bridge::GetWorkers()
+    {
+        if(!workers)
+        {
+            size_t size = workerCount;
+            if(size == 0)
+                size = std::thread::hardware_concurrency();
+            if(size < 2)
+                size = 2;
+            workers = std::make_unique<WorkerPool>(size);
+        }
+        return *workers;
+    }
+
+    void Bridge::SetWorkerCount(size_t count)
+    {
+        workerCount = count;
+    }
+
+    void Bridge::SetStreamWindow(size_t window)
+    {
+        streamWindow = window;
+    }
+
+    void Bridge::SetStreamWorkers(size_t count)
+    {
+        streamWorkerCount = count;
+    }
+
+    void Bridge::SetStreamTimeout(std::chrono::milliseconds timeout)
+    {
+        streamTimeout = timeout;
+    }
+
+    void Bridge::PostToWindow(WinId winId, Job job)
+    {
+        // 窗口已关闭时丢弃
+        if(auto transport = GetTransport(winId))
+            transport->Post(std::move(job));
+    }
+
+    void Bridge::Pump(WinId winId)
+    {
+        if(auto transport = GetTransport(winId))
+            transport->Pump();
     }
 
     Bridge& Bridge::GetInstance()
@@ -82,8 +1165,52 @@ namespace ezi
         static Bridge instance;
         return instance;
     }
+
+    FunctionEntry& Bridge::Define(String name, Handler handler, ContextAsyncFunction async, StreamFunction stream)
+    {
+        // 重复注册只替换处理函数，保留统计、优先级和幂等设置
+        auto& entry   = Intern(std::move(name));
+        entry.handler = std::move(handler);
+        entry.async   = std::move(async);
+        entry.stream  = std::move(stream);
+        return entry;
+    }
+
     void Bridge::Register(String name, Function func)
     {
-        functions[name] = func;
+        Define(std::move(name),
+            [func](const CallContext&, Envelope& envelope) { return func(envelope.TakeArgs()); },
+            nullptr,
+            nullptr);
+    }
+
+    void Bridge::Register(String name, ContextFunction func)
+    {
+        Define(std::move(name),
+            [func](const CallContext& context, Envelope& envelope) { return func(context, envelope.TakeArgs()); },
+            nullptr,
+            nullptr);
+    }
+
+    void Bridge::RegisterAsync(String name, AsyncFunction func, Priority priority)
+    {
+        RegisterAsync(
+            name, [func](CallContext, Object args) { return func(std::move(args)); }, priority);
+    }
+
+    void Bridge::RegisterAsync(String name, ContextAsyncFunction func, Priority priority)
+    {
+        Define(std::move(name), nullptr, std::move(func), nullptr).priority = priority;
+    }
+
+    void Bridge::RegisterStream(String name, StreamFunction func, Priority priority)
+    {
+        Define(std::move(name), nullptr, nullptr, std::move(func)).priority = priority;
+    }
+
+    void Bridge::RegisterAsync(String name, FutureFunction func, Priority priority)
+    {
+        RegisterAsync(
+            name, [func](Object args) { return Private::AwaitFuture(func, std::move(args)); }, priority);
     }
-} // namespace ezi
\ No newline at end of file
+} // namespace ezi
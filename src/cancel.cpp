@@ -0,0 +1,70 @@
+#include "cancel.hpp"
+#include <thread>
+#include "binding.hpp"
+
+namespace ezi
+{
+    CancellationToken CancellationToken::Create()
+    {
+        CancellationToken token;
+        token.state = std::make_shared<State>();
+        return token;
+    }
+
+    bool CancellationToken::IsCancelled() const
+    {
+        return state && state->cancelled.load(std::memory_order_acquire);
+    }
+
+    void CancellationToken::ThrowIfCancelled() const
+    {
+        if(IsCancelled())
+            throw BridgeError("cancelled", "Call cancelled");
+    }
+
+    bool CancellationToken::WaitFor(std::chrono::milliseconds timeout) const
+    {
+        if(!state)
+        {
+            std::this_thread::sleep_for(timeout);
+            return false;
+        }
+        std::unique_lock lock(state->mutex);
+        return state->condition.wait_for(
+            lock, timeout, [this] { return state->cancelled.load(std::memory_order_acquire); });
+    }
+
+    void CancellationToken::OnCancel(std::function<void()> callback) const
+    {
+        if(!state)
+            return;
+        {
+            std::lock_guard lock(state->mutex);
+            if(!state->cancelled.load(std::memory_order_acquire))
+            {
+                state->callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    void CancellationToken::Cancel() const
+    {
+        if(!state)
+            return;
+
+        std::vector<std::function<void()>> callbacks;
+        {
+            std::lock_guard lock(state->mutex);
+            if(state->cancelled.exchange(true, std::memory_order_acq_rel))
+                return;
+            callbacks.swap(state->callbacks);
+        }
+        state->condition.notify_all();
+        for(auto& callback : callbacks)
+        {
+            callback();
+        }
+    }
+}
@@ -0,0 +1,377 @@
+#include "envelope.hpp"
+#include <stdexcept>
+#include "binding.hpp"
+
+namespace ezi
+{
+    namespace Private
+    {
+        [[noreturn]] static void ThrowInvalid()
+        {
+            throw std::runtime_error("Invalid bridge request");
+        }
+
+        // JSON：只定位值的范围，不构建对象
+        static void SkipSpace(std::string_view text, size_t& pos)
+        {
+            while(pos < text.size()
+                && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n'))
+            {
+                pos++;
+            }
+        }
+
+        static void Expect(std::string_view text, size_t& pos, char c)
+        {
+            SkipSpace(text, pos);
+            if(pos >= text.size() || text[pos] != c)
+                ThrowInvalid();
+            pos++;
+        }
+
+        static void SkipString(std::string_view text, size_t& pos)
+        {
+            for(pos++; pos < text.size(); pos++)
+            {
+                if(text[pos] == '\\')
+                    pos++;
+                else if(text[pos] == '"')
+                {
+                    pos++;
+                    return;
+                }
+            }
+            ThrowInvalid();
+        }
+
+        static void SkipValue(std::string_view text, size_t& pos)
+        {
+            SkipSpace(text, pos);
+            if(pos >= text.size())
+                ThrowInvalid();
+
+            char c = text[pos];
+            if(c == '"')
+            {
+                SkipString(text, pos);
+                return;
+            }
+            if(c == '{' || c == '[')
+            {
+                size_t depth = 0;
+                while(pos < text.size())
+                {
+                    c = text[pos];
+                    if(c == '"')
+                    {
+                        SkipString(text, pos);
+                        continue;
+                    }
+                    pos++;
+                    if(c == '{' || c == '[')
+                        depth++;
+                    else if((c == '}' || c == ']') && --depth == 0)
+                        return;
+                }
+                ThrowInvalid();
+            }
+            while(pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' && text[pos] != ' '
+                && text[pos] != '\t' && text[pos] != '\r' && text[pos] != '\n')
+            {
+                pos++;
+            }
+        }
+
+        // msgpack：按类型头跳过值
+        static uint64_t ReadLength(std::string_view data, size_t& pos, size_t bytes)
+        {
+            if(data.size() - pos < bytes)
+                ThrowInvalid();
+            uint64_t value = 0;
+            for(size_t i = 0; i < bytes; i++)
+            {
+                value = (value << 8) | static_cast<uint8_t>(data[pos++]);
+            }
+            return value;
+        }
+
+        static void Advance(std::string_view data, size_t& pos, uint64_t bytes)
+        {
+            if(data.size() - pos < bytes)
+                ThrowInvalid();
+            pos += bytes;
+        }
+
+        static void SkipPacked(std::string_view data, size_t& pos);
+
+        static void SkipEntries(std::string_view data, size_t& pos, uint64_t count)
+        {
+            for(uint64_t i = 0; i < count; i++)
+            {
+                SkipPacked(data, pos);
+            }
+        }
+
+        static void SkipPacked(std::string_view data, size_t& pos)
+        {
+            uint8_t b = static_cast<uint8_t>(ReadLength(data, pos, 1));
+            if(b <= 0x7f || b >= 0xe0 || b == 0xc0 || b == 0xc2 || b == 0xc3)
+                return;
+            if((b & 0xf0) == 0x80)
+                return SkipEntries(data, pos, (b & 0x0f) * 2);
+            if((b & 0xf0) == 0x90)
+                return SkipEntries(data, pos, b & 0x0f);
+            if((b & 0xe0) == 0xa0)
+                return Advance(data, pos, b & 0x1f);
+
+            switch(b)
+            {
+            case 0xc4:
+            case 0xd9:
+                return Advance(data, pos, ReadLength(data, pos, 1));
+            case 0xc5:
+            case 0xda:
+                return Advance(data, pos, ReadLength(data, pos, 2));
+            case 0xc6:
+            case 0xdb:
+                return Advance(data, pos, ReadLength(data, pos, 4));
+            case 0xc7:
+                return Advance(data, pos, ReadLength(data, pos, 1) + 1);
+            case 0xc8:
+                return Advance(data, pos, ReadLength(data, pos, 2) + 1);
+            case 0xc9:
+                return Advance(data, pos, ReadLength(data, pos, 4) + 1);
+            case 0xcc:
+            case 0xd0:
+                return Advance(data, pos, 1);
+            case 0xcd:
+            case 0xd1:
+            case 0xd4:
+                return Advance(data, pos, 2);
+            case 0xd5:
+                return Advance(data, pos, 3);
+            case 0xca:
+            case 0xce:
+            case 0xd2:
+                return Advance(data, pos, 4);
+            case 0xd6:
+                return Advance(data, pos, 5);
+            case 0xcb:
+            case 0xcf:
+            case 0xd3:
+                return Advance(data, pos, 8);
+            case 0xd7:
+                return Advance(data, pos, 9);
+            case 0xd8:
+                return Advance(data, pos, 17);
+            case 0xdc:
+                return SkipEntries(data, pos, ReadLength(data, pos, 2));
+            case 0xdd:
+                return SkipEntries(data, pos, ReadLength(data, pos, 4));
+            case 0xde:
+                return SkipEntries(data, pos, ReadLength(data, pos, 2) * 2);
+            case 0xdf:
+                return SkipEntries(data, pos, ReadLength(data, pos, 4) * 2);
+            }
+            ThrowInvalid();
+        }
+
+        // 读取容器头，返回元素个数；不是所需容器时返回false
+        static bool ReadContainer(std::string_view data, size_t& pos, bool map, uint64_t& count)
+        {
+            if(pos >= data.size())
+                ThrowInvalid();
+            uint8_t b = static_cast<uint8_t>(data[pos]);
+            if((b & 0xf0) == (map ? 0x80 : 0x90))
+            {
+                pos++;
+                count = b & 0x0f;
+                return true;
+            }
+            if(b == (map ? 0xde : 0xdc) || b == (map ? 0xdf : 0xdd))
+            {
+                pos++;
+                count = ReadLength(data, pos, (b & 1) ? 4 : 2);
+                return true;
+            }
+            return false;
+        }
+
+        static std::string_view ReadKey(std::string_view data, size_t& pos)
+        {
+            uint8_t  b = static_cast<uint8_t>(ReadLength(data, pos, 1));
+            uint64_t size;
+            if((b & 0xe0) == 0xa0)
+                size = b & 0x1f;
+            else if(b >= 0xd9 && b <= 0xdb)
+                size = ReadLength(data, pos, size_t(1) << (b - 0xd9));
+            else
+                ThrowInvalid();
+            auto start = pos;
+            Advance(data, pos, size);
+            return data.substr(start, size);
+        }
+    }
+
+    Envelope::Envelope(Json args) : args(std::move(args)) { }
+
+    bool Envelope::Open(Payload payload, WireFormat format, std::vector<Envelope>& calls)
+    {
+        std::string_view data(*payload);
+        size_t           pos = 0;
+
+        auto field = [](Envelope& call, std::string_view key, std::string_view value)
+        {
+            if(key == "args")
+            {
+                call.rawArgs = value;
+                call.parsed  = false;
+                return;
+            }
+            if(key != "id" && key != "func")
+                return;
+            Json parsed = call.format == WireFormat::msgpack ? Json::from_msgpack(value.begin(), value.end())
+                                                             : Json::parse(value);
+            (key == "id" ? call.id : call.func) = std::move(parsed);
+        };
+
+        auto scan = [&]()
+        {
+            Envelope call;
+            call.payload = payload;
+            call.format  = format;
+
+            if(format == WireFormat::msgpack)
+            {
+                uint64_t count;
+                if(!Private::ReadContainer(data, pos, true, count))
+                    Private::ThrowInvalid();
+                for(uint64_t i = 0; i < count; i++)
+                {
+                    auto key   = Private::ReadKey(data, pos);
+                    auto start = pos;
+                    Private::SkipPacked(data, pos);
+                    field(call, key, data.substr(start, pos - start));
+                }
+                calls.push_back(std::move(call));
+                return;
+            }
+
+            Private::Expect(data, pos, '{');
+            Private::SkipSpace(data, pos);
+            if(pos < data.size() && data[pos] == '}')
+            {
+                pos++;
+                calls.push_back(std::move(call));
+                return;
+            }
+            while(true)
+            {
+                Private::SkipSpace(data, pos);
+                auto keyStart = pos;
+                if(pos >= data.size() || data[pos] != '"')
+                    Private::ThrowInvalid();
+                Private::SkipString(data, pos);
+                auto key = data.substr(keyStart + 1, pos - keyStart - 2);
+
+                Private::Expect(data, pos, ':');
+                Private::SkipSpace(data, pos);
+                auto start = pos;
+                Private::SkipValue(data, pos);
+                field(call, key, data.substr(start, pos - start));
+
+                Private::SkipSpace(data, pos);
+                if(pos < data.size() && data[pos] == ',')
+                {
+                    pos++;
+                    continue;
+                }
+                Private::Expect(data, pos, '}');
+                break;
+            }
+            calls.push_back(std::move(call));
+        };
+
+        if(format == WireFormat::msgpack)
+        {
+            uint64_t count;
+            if(!Private::ReadContainer(data, pos, false, count))
+            {
+                scan();
+                return false;
+            }
+            calls.reserve(count);
+            for(uint64_t i = 0; i < count; i++)
+            {
+                scan();
+            }
+            return true;
+        }
+
+        Private::SkipSpace(data, pos);
+        if(pos >= data.size() || data[pos] != '[')
+        {
+            scan();
+            return false;
+        }
+        pos++;
+        Private::SkipSpace(data, pos);
+        if(pos < data.size() && data[pos] == ']')
+            return true;
+        while(true)
+        {
+            scan();
+            Private::SkipSpace(data, pos);
+            if(pos < data.size() && data[pos] == ',')
+            {
+                pos++;
+                continue;
+            }
+            Private::Expect(data, pos, ']');
+            return true;
+        }
+    }
+
+    const Json& Envelope::GetId() const
+    {
+        return id;
+    }
+
+    const Json& Envelope::GetFunc() const
+    {
+        return func;
+    }
+
+    std::string_view Envelope::GetRawArgs() const
+    {
+        return rawArgs;
+    }
+
+    WireFormat Envelope::GetFormat() const
+    {
+        return format;
+    }
+
+    const Json& Envelope::GetArgs()
+    {
+        if(parsed)
+            return args;
+        try
+        {
+            args = format == WireFormat::msgpack ? Json::from_msgpack(rawArgs.begin(), rawArgs.end())
+                                                 : Json::parse(rawArgs);
+        }
+        catch(const std::exception& e)
+        {
+            throw BridgeError("invalid_argument", String("Invalid arguments: ") + e.what());
+        }
+        parsed = true;
+        return args;
+    }
+
+    Json Envelope::TakeArgs()
+    {
+        GetArgs();
+        return std::move(args);
+    }
+}
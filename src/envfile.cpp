@@ -0,0 +1,25 @@
+#include "ezienv.hpp"
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace ezi
+{
+    Json EziEnv::LoadFile(const String& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file.is_open())
+            return nullptr;
+
+        std::vector<uint8_t> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return Json::from_msgpack(binary);
+    }
+
+    void EziEnv::SaveFile(const String& path, const Json& data)
+    {
+        // 以二进制方式写入，文本模式会改写msgpack中的换行字节
+        std::ofstream        file(path, std::ios::binary | std::ios::trunc);
+        std::vector<uint8_t> binary = Json::to_msgpack(data);
+        file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    }
+}
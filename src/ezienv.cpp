@@ -41,21 +41,13 @@ namespace ezi
 
         auto programPath = utf16ToUtf8(std::wstring(programPathC));
 
-        std::ifstream envFile(envFilePath);
-
-        if(envFile.is_open())
+        try
         {
-            try
-            {
-                std::vector<uint8_t> binary(
-                    (std::istreambuf_iterator<char>(envFile)), std::istreambuf_iterator<char>());
-
-                envData = Json::from_msgpack(binary);
-            }
-            catch(const Json::parse_error& e)
-            {
-                println("failed to parse env file:", envFilePath);
-            }
+            envData = LoadFile(envFilePath);
+        }
+        catch(const Json::parse_error& e)
+        {
+            println("failed to parse env file:", envFilePath);
         }
 
         if(envData.contains("ownerPath") == false)
@@ -67,10 +59,7 @@ namespace ezi
             envData["appName"]   = appName;
             envData["package"]   = package;
             envData["version"]   = CFGRES<std::string>("application.version", "0.0.0");
-            std::ofstream newEnvFile(envFilePath);
-            newEnvFile << envData.dump();
-            std::vector<uint8_t> binary = Json::to_msgpack(envData);
-            newEnvFile.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+            SaveFile(envFilePath, envData);
         }
 
         auto ownerPath    = envData.value("ownerPath", "");
@@ -105,9 +94,7 @@ namespace ezi
                 envData["appName"]   = appName;
                 envData["package"]   = package;
                 envData["version"]   = CFGRES<std::string>("application.version", "0.0.0");
-                std::ofstream        newEnvFile(envFilePath);
-                std::vector<uint8_t> binary = Json::to_msgpack(envData);
-                newEnvFile.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+                SaveFile(envFilePath, envData);
             }
         }
     }
@@ -121,9 +108,7 @@ namespace ezi
     void EziEnv::SaveVar(std::string key, Object value)
     {
         envData[key] = value;
-        std::ofstream        envFile(envFilePath);
-        std::vector<uint8_t> binary = Json::to_msgpack(envData);
-        envFile.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        SaveFile(envFilePath, envData);
     }
 
     std::string EziEnv::GetVar(std::string key)
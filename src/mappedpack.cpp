@@ -0,0 +1,99 @@
+#include "mappedpack.hpp"
+#include "assetindex.hpp"
+#include "platform.hpp"
+#if OS(LINUX)
+    #include <cerrno>
+    #include <cstdlib>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <filesystem>
+    #include <stdexcept>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+// 链接器为名字是合法标识符的段生成的起止符号，没有链接资源包时为空
+extern "C"
+{
+    extern const uint8_t __start_ezi_assets[] __attribute__((weak));
+    extern const uint8_t __stop_ezi_assets[] __attribute__((weak));
+}
+
+namespace ezi
+{
+    MappedPack::MappedPack(BinaryData data, void* mapping, size_t mappedSize)
+        : data(data), mapping(mapping), mappedSize(mappedSize)
+    {
+        Advise();
+    }
+
+    MappedPack::~MappedPack()
+    {
+        if(mapping)
+            munmap(mapping, mappedSize);
+    }
+
+    void MappedPack::Advise()
+    {
+        // 索引在启动时就要用到，提前读入；madvise要求按页对齐，向外扩到整页
+        BinaryData index = AssetIndex::Locate(data);
+        if(index.empty())
+            return;
+        uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(index.data()) & ~(page - 1);
+        uintptr_t end   = reinterpret_cast<uintptr_t>(index.data() + index.size());
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+    }
+
+    std::unique_ptr<MappedPack> MappedPack::Open(const String& path)
+    {
+        int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(file < 0)
+            throw std::runtime_error("Failed to open asset pack " + path + ": " + std::strerror(errno));
+
+        struct stat info;
+        if(fstat(file, &info) != 0 || info.st_size <= 0)
+        {
+            close(file);
+            throw std::runtime_error("Invalid asset pack size: " + path);
+        }
+
+        // 映射建立后文件描述符不再需要
+        size_t size    = static_cast<size_t>(info.st_size);
+        void*  mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+        close(file);
+        if(mapping == MAP_FAILED)
+            throw std::runtime_error("Failed to map asset pack " + path + ": " + std::strerror(errno));
+
+        BinaryData data(static_cast<const uint8_t*>(mapping), size);
+        return std::unique_ptr<MappedPack>(new MappedPack(data, mapping, size));
+    }
+
+    std::unique_ptr<MappedPack> MappedPack::FromExecutable()
+    {
+        // 段随程序文件一起按需映射，与文件映射一样懒加载并在进程间共享
+        const uint8_t* begin = __start_ezi_assets;
+        const uint8_t* end   = __stop_ezi_assets;
+        if(!begin || end <= begin)
+            return nullptr;
+        BinaryData data(begin, static_cast<size_t>(end - begin));
+        return std::unique_ptr<MappedPack>(new MappedPack(data, nullptr, 0));
+    }
+
+    String MappedPack::GetDefaultPath()
+    {
+        if(const char* path = std::getenv("EZI_ASSETS"); path && *path)
+            return path;
+        std::error_code       error;
+        std::filesystem::path executable = std::filesystem::read_symlink("/proc/self/exe", error);
+        if(error)
+            return "ezi.assets";
+        return (executable.parent_path() / "ezi.assets").string();
+    }
+
+    BinaryData MappedPack::GetData() const
+    {
+        return data;
+    }
+}
+#endif
@@ -0,0 +1,121 @@
+#include "memo.hpp"
+
+namespace ezi
+{
+    void MemoCache::SetTopics(const String& func, const std::vector<String>& invalidatedBy)
+    {
+        std::lock_guard lock(mutex);
+        functions[func].clear();
+        for(auto& [topic, funcs] : topics)
+        {
+            std::erase(funcs, func);
+        }
+        for(auto& topic : invalidatedBy)
+        {
+            topics[topic].push_back(func);
+        }
+    }
+
+    Json MemoCache::Get(
+        const String& func, const std::string& key, std::chrono::milliseconds ttl, const Compute& compute, bool& hit)
+    {
+        std::shared_ptr<Slot>    slot;
+        std::shared_future<Json> shared;
+        std::promise<Json>       promise;
+        bool                     reentrant = false;
+        {
+            std::lock_guard lock(mutex);
+            auto&           slots = functions[func];
+            auto            it    = slots.find(key);
+            if(it != slots.end() && !it->second->ready && it->second->owner == std::this_thread::get_id())
+            {
+                reentrant = true;
+            }
+            else if(it != slots.end() && (!it->second->ready || Clock::now() < it->second->expires))
+            {
+                shared = it->second->result;
+            }
+            else
+            {
+                if(it == slots.end() && slots.size() >= MAXSLOTS)
+                    Sweep(slots);
+                slot         = std::make_shared<Slot>();
+                slot->result = promise.get_future().share();
+                slot->owner  = std::this_thread::get_id();
+                slots[key]   = slot;
+            }
+        }
+
+        // 处理函数重入：等待只会等到自己，直接执行且不缓存
+        if(reentrant)
+        {
+            hit = false;
+            return compute();
+        }
+
+        // 已缓存或正在执行，等待同一个结果
+        if(shared.valid())
+        {
+            hit = true;
+            return shared.get();
+        }
+
+        hit = false;
+        try
+        {
+            Json result = compute();
+            promise.set_value(result);
+
+            std::lock_guard lock(mutex);
+            // 执行期间被失效时槽已被移除，结果不再缓存
+            auto& slots = functions[func];
+            auto  it    = slots.find(key);
+            if(it != slots.end() && it->second == slot)
+            {
+                slot->ready   = true;
+                slot->expires = Clock::now() + ttl;
+            }
+            return result;
+        }
+        catch(...)
+        {
+            promise.set_exception(std::current_exception());
+            std::lock_guard lock(mutex);
+            auto&           slots = functions[func];
+            auto            it    = slots.find(key);
+            if(it != slots.end() && it->second == slot)
+                slots.erase(it);
+            throw;
+        }
+    }
+
+    void MemoCache::Sweep(Slots& slots)
+    {
+        auto now = Clock::now();
+        std::erase_if(slots, [now](auto& item) { return item.second->ready && item.second->expires <= now; });
+        // 参数各不相同的调用过多时放弃已缓存的结果，执行中的保留以便并发调用共用
+        if(slots.size() >= MAXSLOTS)
+            std::erase_if(slots, [](auto& item) { return item.second->ready; });
+    }
+
+    void MemoCache::Invalidate(const String& topic)
+    {
+        std::lock_guard lock(mutex);
+        auto            it = topics.find(topic);
+        if(it == topics.end())
+            return;
+        for(auto& func : it->second)
+        {
+            functions[func].clear();
+        }
+    }
+
+    void MemoCache::Clear()
+    {
+        std::lock_guard lock(mutex);
+        for(auto& [func, slots] : functions)
+        {
+            slots.clear();
+        }
+    }
+}
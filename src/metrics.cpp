@@ -0,0 +1,102 @@
+#include "metrics.hpp"
+#include <bit>
+
+namespace ezi
+{
+    size_t Histogram::BucketOf(uint64_t value)
+    {
+        constexpr uint64_t SUBCOUNT = 1 << SUBBITS;
+        // 小于SUBCOUNT的值逐个计数，之后每个2的幂区间再均分为SUBCOUNT份
+        if(value < SUBCOUNT)
+            return static_cast<size_t>(value);
+
+        int exp = std::bit_width(value) - 1;
+        if(exp > MAXEXP)
+            return BUCKETS - 1;
+        uint64_t sub = (value >> (exp - SUBBITS)) - SUBCOUNT;
+        return static_cast<size_t>(SUBCOUNT + (exp - SUBBITS) * SUBCOUNT + sub);
+    }
+
+    uint64_t Histogram::ValueOf(size_t bucket)
+    {
+        constexpr uint64_t SUBCOUNT = 1 << SUBBITS;
+        if(bucket < SUBCOUNT)
+            return bucket;
+
+        uint64_t exp = (bucket - SUBCOUNT) / SUBCOUNT + SUBBITS;
+        uint64_t sub = (bucket - SUBCOUNT) % SUBCOUNT;
+        // 返回区间中点
+        uint64_t low = (SUBCOUNT + sub) << (exp - SUBBITS);
+        return low + (uint64_t(1) << (exp - SUBBITS)) / 2;
+    }
+
+    void Histogram::Record(uint64_t ns)
+    {
+        buckets[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t current = max.load(std::memory_order_relaxed);
+        while(ns > current && !max.compare_exchange_weak(current, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    uint64_t Histogram::Percentile(double percent) const
+    {
+        uint64_t all = 0;
+        for(auto& bucket : buckets)
+        {
+            all += bucket.load(std::memory_order_relaxed);
+        }
+        if(all == 0)
+            return 0;
+
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * all + 0.5);
+        if(rank == 0)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for(size_t i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if(seen >= rank)
+                return ValueOf(i);
+        }
+        return max.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::GetCount() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    Json Histogram::ToJson() const
+    {
+        uint64_t n = GetCount();
+        return {
+            { "count", n },
+            { "meanUs", n ? total.load(std::memory_order_relaxed) / 1000.0 / n : 0.0 },
+            { "p50Us", Percentile(50) / 1000.0 },
+            { "p90Us", Percentile(90) / 1000.0 },
+            { "p99Us", Percentile(99) / 1000.0 },
+            { "maxUs", max.load(std::memory_order_relaxed) / 1000.0 },
+        };
+    }
+
+    Json FunctionMetrics::ToJson() const
+    {
+        static const char* names[] = { "parse", "dispatch", "serialize", "post" };
+
+        Json result = {
+            { "calls", calls.load(std::memory_order_relaxed) },
+            { "errors", errors.load(std::memory_order_relaxed) },
+            { "memoHits", memoHits.load(std::memory_order_relaxed) },
+        };
+        for(size_t i = 0; i < phases.size(); i++)
+        {
+            result[names[i]] = phases[i].ToJson();
+        }
+        return result;
+    }
+}
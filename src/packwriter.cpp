@@ -0,0 +1,255 @@
+#include "packwriter.hpp"
+#include "assetindex.hpp"
+#include "assetstream.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <zdict.h>
+#include <zstd.h>
+
+namespace ezi
+{
+    namespace Private
+    {
+        struct CompressContextDeleter
+        {
+            void operator()(ZSTD_CCtx* context) const
+            {
+                ZSTD_freeCCtx(context);
+            }
+        };
+
+        static ZSTD_CCtx* GetCompressContext()
+        {
+            thread_local std::unique_ptr<ZSTD_CCtx, CompressContextDeleter> context(ZSTD_createCCtx());
+            if(!context)
+                throw std::runtime_error("Failed to create zstd compression context");
+            return context.get();
+        }
+
+        // 跳转表记录的帧数，data须以跳转表结尾
+        static uint32_t GetFrameCount(BinaryData data)
+        {
+            uint32_t count = 0;
+            for(int i = 0; i < 4; i++)
+            {
+                count |= static_cast<uint32_t>(data[data.size() - AssetStream::FOOTERSIZE + i]) << (8 * i);
+            }
+            return count;
+        }
+
+        static void AppendUint32(std::vector<uint8_t>& out, uint32_t value)
+        {
+            for(int i = 0; i < 4; i++)
+            {
+                out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+    }
+
+    void CompressDictionaryDeleter::operator()(ZSTD_CDict* dictionary) const
+    {
+        ZSTD_freeCDict(dictionary);
+    }
+
+    std::vector<uint8_t> AssetPackWriter::TrainDictionary(const std::vector<BinaryData>& samples, size_t capacity)
+    {
+        std::vector<uint8_t> buffer;
+        std::vector<size_t>  sizes;
+        for(auto& sample : samples)
+        {
+            buffer.insert(buffer.end(), sample.begin(), sample.end());
+            sizes.push_back(sample.size());
+        }
+
+        std::vector<uint8_t> dictionary(capacity);
+        size_t               size = ZDICT_trainFromBuffer(
+            dictionary.data(), dictionary.size(), buffer.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+        if(ZDICT_isError(size))
+            return {};
+        dictionary.resize(size);
+        return dictionary;
+    }
+
+    std::vector<uint8_t> AssetPackWriter::Compress(BinaryData content, int level, const ZSTD_CDict* dictionary)
+    {
+        std::vector<uint8_t> frame(ZSTD_compressBound(content.size()));
+        ZSTD_CCtx*           context = Private::GetCompressContext();
+        size_t               written;
+        if(dictionary)
+        {
+            written = ZSTD_compress_usingCDict(
+                context, frame.data(), frame.size(), content.data(), content.size(), dictionary);
+        }
+        else
+        {
+            written = ZSTD_compressCCtx(context, frame.data(), frame.size(), content.data(), content.size(), level);
+        }
+        if(ZSTD_isError(written))
+            throw std::runtime_error(ZSTD_getErrorName(written));
+        frame.resize(written);
+        return frame;
+    }
+
+    std::vector<uint8_t> AssetPackWriter::CompressSeekable(BinaryData content, int level, size_t frameSize)
+    {
+        if(frameSize == 0 || frameSize > UINT32_MAX)
+            throw std::runtime_error("Invalid seekable frame size");
+
+        std::vector<uint8_t>                       out;
+        std::vector<std::pair<uint32_t, uint32_t>> table;
+        for(size_t begin = 0; begin < content.size() || table.empty(); begin += frameSize)
+        {
+            BinaryData frame      = content.subspan(begin, std::min(frameSize, content.size() - begin));
+            auto       compressed = Compress(frame, level);
+            out.insert(out.end(), compressed.begin(), compressed.end());
+            table.emplace_back(static_cast<uint32_t>(compressed.size()), static_cast<uint32_t>(frame.size()));
+        }
+
+        // 跳转表为一个可跳过帧：魔数、内容长度、各帧{压缩大小, 原始大小}、帧数、描述符、seekable魔数
+        Private::AppendUint32(out, AssetStream::SKIPPABLEMAGIC);
+        Private::AppendUint32(out, static_cast<uint32_t>(table.size() * 8 + AssetStream::FOOTERSIZE));
+        for(auto& [compressed, original] : table)
+        {
+            Private::AppendUint32(out, compressed);
+            Private::AppendUint32(out, original);
+        }
+        Private::AppendUint32(out, static_cast<uint32_t>(table.size()));
+        out.push_back(0);
+        Private::AppendUint32(out, AssetStream::SEEKABLEMAGIC);
+        return out;
+    }
+
+    void AssetPackWriter::AddDictionary(const String& name, std::vector<uint8_t> dictionary)
+    {
+        if(dictionaries.contains(name))
+            throw std::runtime_error("Duplicate asset dictionary: " + name);
+        manifest[AssetPack::DICTIONARIES][name] = Append(dictionary);
+        dictionaries.emplace(name, std::move(dictionary));
+    }
+
+    const ZSTD_CDict* AssetPackWriter::GetCompressDictionary(const String& name, int level)
+    {
+        auto& dictionary = prepared[{ name, level }];
+        if(!dictionary)
+        {
+            auto it = dictionaries.find(name);
+            if(it == dictionaries.end())
+                throw std::runtime_error("Unknown asset dictionary: " + name);
+            dictionary.reset(ZSTD_createCDict(it->second.data(), it->second.size(), level));
+            if(!dictionary)
+                throw std::runtime_error("Invalid asset dictionary: " + name);
+        }
+        return dictionary.get();
+    }
+
+    void AssetPackWriter::Add(const String& uri, BinaryData content, int level, const String& dictionary)
+    {
+        const ZSTD_CDict* prepared = dictionary.empty() ? nullptr : GetCompressDictionary(dictionary, level);
+        AddCompressed(uri, Compress(content, level, prepared), dictionary);
+    }
+
+    void AssetPackWriter::AddSeekable(const String& uri, BinaryData content, int level, size_t frameSize)
+    {
+        AddCompressedSeekable(uri, CompressSeekable(content, level, frameSize));
+    }
+
+    void AssetPackWriter::AddCompressed(const String& uri, BinaryData compressed, const String& dictionary)
+    {
+        if(manifest.contains(uri) || uri == AssetPack::DICTIONARIES)
+            throw std::runtime_error("Duplicate asset: " + uri);
+        if(!dictionary.empty() && !dictionaries.contains(dictionary))
+            throw std::runtime_error("Unknown asset dictionary: " + dictionary);
+        manifest[uri] = Append(compressed);
+        if(!dictionary.empty())
+            manifest[uri]["dict"] = dictionary;
+    }
+
+    void AssetPackWriter::AddCompressedSeekable(const String& uri, BinaryData compressed)
+    {
+        if(!AssetStream::IsSeekable(compressed))
+            throw std::runtime_error("Invalid seekable asset: " + uri);
+        AddCompressed(uri, compressed);
+        manifest[uri]["seekable"] = true;
+    }
+
+    void AssetPackWriter::AddStored(const String& uri, BinaryData content)
+    {
+        if(manifest.contains(uri) || uri == AssetPack::DICTIONARIES)
+            throw std::runtime_error("Duplicate asset: " + uri);
+        manifest[uri]           = Append(content);
+        manifest[uri]["stored"] = true;
+    }
+
+    void AssetPackWriter::AddAlias(const String& uri, const String& target)
+    {
+        auto it = manifest.find(target);
+        if(it == manifest.end() || target == AssetPack::DICTIONARIES)
+            throw std::runtime_error("Unknown asset: " + target);
+        if(manifest.contains(uri) || uri == AssetPack::DICTIONARIES)
+            throw std::runtime_error("Duplicate asset: " + uri);
+        manifest[uri] = *it;
+    }
+
+    std::vector<uint8_t> AssetPackWriter::Finish(IndexFormat format, int level)
+    {
+        if(format == IndexFormat::json)
+        {
+            // 旧的运行时会把直接存放的数据当作zstd帧解压，不认识字典，并按第一帧的长度解压分帧存放的数据
+            if(!dictionaries.empty())
+                throw std::runtime_error("Asset dictionaries require the binary index");
+            for(auto& [uri, range] : manifest.items())
+            {
+                if(range.value("stored", false))
+                    throw std::runtime_error("Stored asset requires the binary index: " + uri);
+                if(range.value("seekable", false)
+                    && Private::GetFrameCount(BinaryData(data).subspan(range["offset"], range["size"])) > 1)
+                    throw std::runtime_error("Multi-frame seekable asset requires the binary index: " + uri);
+            }
+            String text = manifest.dump();
+            auto   zip  = Compress(BinaryData(reinterpret_cast<const uint8_t*>(text.data()), text.size()), level);
+            Append(zip);
+            Private::AppendUint32(data, static_cast<uint32_t>(zip.size()));
+            return std::move(data);
+        }
+
+        auto toMeta = [](const Json& range) -> AssetMeta
+        { return { range["offset"].get<size_t>(), range["size"].get<size_t>() }; };
+
+        // 字典序号按名字排序，与旧清单加载时一致
+        std::vector<std::pair<String, AssetMeta>> dictionaryList;
+        std::unordered_map<String, int>           dictionaryIds;
+        if(auto it = manifest.find(AssetPack::DICTIONARIES); it != manifest.end())
+        {
+            for(auto& [name, range] : it->items())
+            {
+                dictionaryIds[name] = static_cast<int>(dictionaryList.size());
+                dictionaryList.emplace_back(name, toMeta(range));
+            }
+        }
+
+        std::vector<std::pair<String, AssetMeta>> entries;
+        for(auto& [uri, range] : manifest.items())
+        {
+            if(uri == AssetPack::DICTIONARIES)
+                continue;
+            AssetMeta meta = toMeta(range);
+            if(auto dictionary = range.find("dict"); dictionary != range.end())
+                meta.dictionary = dictionaryIds.at(dictionary->get<String>());
+            // 标记在写入时记录，不按内容末尾的魔数猜测
+            meta.stored   = range.value("stored", false);
+            meta.seekable = range.value("seekable", false);
+            entries.emplace_back(uri, meta);
+        }
+
+        auto index = AssetIndex::Build(entries, dictionaryList);
+        data.insert(data.end(), index.begin(), index.end());
+        return std::move(data);
+    }
+
+    Json AssetPackWriter::Append(BinaryData content)
+    {
+        size_t offset = data.size();
+        data.insert(data.end(), content.begin(), content.end());
+        return { { "offset", offset }, { "size", content.size() } };
+    }
+}
@@ -0,0 +1,120 @@
+#include "recorder.hpp"
+#include <stdexcept>
+
+namespace ezi
+{
+    namespace Private
+    {
+        static constexpr char MAGIC[4] = { 'E', 'Z', 'I', 'R' };
+
+        static void WriteUint32(std::ofstream& file, uint32_t value)
+        {
+            char bytes[4];
+            for(int i = 0; i < 4; i++)
+            {
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            file.write(bytes, 4);
+        }
+
+        static bool ReadUint32(std::ifstream& file, uint32_t& value)
+        {
+            unsigned char bytes[4];
+            if(!file.read(reinterpret_cast<char*>(bytes), 4))
+                return false;
+            value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+            return true;
+        }
+    }
+
+    Json RecordedCall::GetArgs() const
+    {
+        if(args.empty())
+            return Json::object();
+        if(format == WireFormat::msgpack)
+            return Json::from_msgpack(args.begin(), args.end());
+        return Json::parse(args);
+    }
+
+    bool Recorder::Start(const String& path)
+    {
+        std::lock_guard lock(mutex);
+        if(file.is_open())
+            file.close();
+
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if(!file)
+            return false;
+        file.write(Private::MAGIC, sizeof(Private::MAGIC));
+        Private::WriteUint32(file, VERSION);
+
+        started = Clock::now();
+        recording.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void Recorder::Stop()
+    {
+        std::lock_guard lock(mutex);
+        recording.store(false, std::memory_order_release);
+        if(file.is_open())
+            file.close();
+    }
+
+    bool Recorder::IsRecording() const
+    {
+        return recording.load(std::memory_order_acquire);
+    }
+
+    void Recorder::Record(const String& func, const String& sender, WireFormat format, std::string_view args)
+    {
+        std::lock_guard lock(mutex);
+        if(!file.is_open())
+            return;
+
+        Json record = {
+            { "t", ElapsedNs(started) },
+            { "func", func },
+            { "sender", sender },
+            { "format", format == WireFormat::msgpack ? "msgpack" : "json" },
+            { "args", Json::binary(std::vector<uint8_t>(args.begin(), args.end())) },
+        };
+        auto bytes = Json::to_msgpack(record);
+        Private::WriteUint32(file, static_cast<uint32_t>(bytes.size()));
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    std::vector<RecordedCall> Recorder::Load(const String& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("Cannot open recording: " + path);
+
+        char     magic[4];
+        uint32_t version;
+        if(!file.read(magic, 4) || std::string_view(magic, 4) != std::string_view(Private::MAGIC, 4)
+            || !Private::ReadUint32(file, version) || version != VERSION)
+            throw std::runtime_error("Not a bridge recording: " + path);
+
+        std::vector<RecordedCall> calls;
+        std::vector<uint8_t>      bytes;
+        uint32_t                  size;
+        while(Private::ReadUint32(file, size))
+        {
+            bytes.resize(size);
+            if(!file.read(reinterpret_cast<char*>(bytes.data()), size))
+                throw std::runtime_error("Truncated recording: " + path);
+
+            Json         record = Json::from_msgpack(bytes);
+            RecordedCall call;
+            call.offsetNs = record.at("t").get<uint64_t>();
+            call.func     = record.at("func").get<String>();
+            call.sender   = record.value("sender", "");
+            call.format   = record.value("format", "json") == "msgpack" ? WireFormat::msgpack : WireFormat::json;
+            auto& args    = record.at("args").get_binary();
+            call.args.assign(args.begin(), args.end());
+            calls.push_back(std::move(call));
+        }
+        return calls;
+    }
+}
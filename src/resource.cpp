@@ -4,15 +4,19 @@
     #pragma comment(lib, "Shlwapi.lib")
 #endif
 #include "fstream"
-#include "application.hpp"
-#include "utils.hpp"
-#include <zstd.h>
+#if OS(WINDOWS)
+    #include "application.hpp"
+    #include "utils.hpp"
+#endif
+#include <cstdlib>
+#include <iterator>
 #include <vector>
 
 namespace ezi
 {
     Resource::Resource()
     {
+#if OS(WINDOWS)
         HRSRC hRes = FindResource(NULL, MAKEINTRESOURCE(1004), RT_RCDATA);
         if(!hRes)
             throw std::runtime_error("Failed to find resource ezi.assets.binary");
@@ -25,43 +29,25 @@ namespace ezi
         void* pData = LockResource(hData);
         DWORD size  = SizeofResource(NULL, hRes);
 
-        assetsBinarys = std::span<const uint8_t>(static_cast<const uint8_t*>(pData), size);
-
-#define MANIFESTSIZEFLAG 4
-
-        std::span<const uint8_t> manifestSizePos = assetsBinarys.subspan(size - MANIFESTSIZEFLAG, MANIFESTSIZEFLAG);
-
-        uint32_t manifestSize = 0;
-        std::memcpy(&manifestSize, manifestSizePos.data(), sizeof(manifestSize));
-
-        if(manifestSize == 0 || manifestSize > assetsBinarys.size())
-            throw std::runtime_error("Invalid asset manifest size");
-
-        std::span<const uint8_t> manifestData
-            = assetsBinarys.subspan(size - manifestSize - MANIFESTSIZEFLAG, manifestSize);
-
-        size_t unZipManifestDataSize = ZSTD_getFrameContentSize(manifestData.data(), manifestData.size());
-        if(unZipManifestDataSize == ZSTD_CONTENTSIZE_ERROR || unZipManifestDataSize == ZSTD_CONTENTSIZE_UNKNOWN)
-        {
-            throw std::runtime_error("无法确定解压后的大小");
-        }
-        std::vector<uint8_t> unZipManifestData(unZipManifestDataSize);
-
-        size_t result = ZSTD_decompress(
-            unZipManifestData.data(), unZipManifestData.size(), manifestData.data(), manifestData.size());
-        if(ZSTD_isError(result))
-        {
-            throw std::runtime_error(ZSTD_getErrorName(result));
-        }
-
-        String manifestJsonStr(reinterpret_cast<const char*>(unZipManifestData.data()), unZipManifestData.size());
+        assets = AssetPack(BinaryData(static_cast<const uint8_t*>(pData), size));
+#elif OS(LINUX)
+        // 优先使用链接进程序的资源包，否则映射 EZI_ASSETS 或程序旁的 ezi.assets
+        pack = MappedPack::FromExecutable();
+        if(!pack)
+            pack = MappedPack::Open(MappedPack::GetDefaultPath());
+        assets = AssetPack(pack->GetData());
+#else
+        // 读入 EZI_ASSETS 或当前目录下的 ezi.assets
+        const char*   envPath = std::getenv("EZI_ASSETS");
+        String        path    = envPath && *envPath ? envPath : "ezi.assets";
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("Failed to open asset pack " + path);
+        packData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        assets = AssetPack(BinaryData(packData.data(), packData.size()));
+#endif
 
-        auto manifestJson = Json::parse(manifestJsonStr);
-        for(auto& [key, value] : manifestJson.items())
-        {
-            assetsMetas[key] = { value["offset"].get<size_t>(), value["size"].get<size_t>() };
-        }
-#if BUILDTYPE(DEBUG)
+#if BUILDTYPE(DEBUG) && OS(WINDOWS)
         auto cwd = Utils::GetArg("--cwd");
         if(!cwd.empty())
         {
@@ -84,10 +70,13 @@ namespace ezi
             exit(1);
         }
 #else
-        auto   configData = GetAssetData("ezi.config.manifest");
+        auto   configData = assets.GetAssetData("ezi.config.manifest");
         String configJsonStr(reinterpret_cast<const char*>(configData.data()), configData.size());
         config = Json::parse(configJsonStr);
 #endif
+
+        // 缓存总量，如 {"resource": {"cacheBytes": 67108864}}
+        cache.SetBudget(at<size_t>(config, "resource.cacheBytes", 32 << 20));
     }
 
     Resource::~Resource()
@@ -100,28 +89,31 @@ namespace ezi
         return instance;
     }
 
-    std::vector<uint8_t> Resource::GetAssetData(const String& uri)
+    AssetBuffer Resource::GetAssetData(const String& uri)
     {
-        auto it = assetsMetas.find(uri);
-        if(it != assetsMetas.end())
-        {
-            AssetMeta&               meta    = it->second;
-            std::span<const uint8_t> zipData = assetsBinarys.subspan(meta.offset, meta.size);
-
-            size_t unZipDataSize = ZSTD_getFrameContentSize(zipData.data(), zipData.size());
-            if(unZipDataSize == ZSTD_CONTENTSIZE_ERROR || unZipDataSize == ZSTD_CONTENTSIZE_UNKNOWN)
-            {
-                throw std::runtime_error("无法确定解压后的大小");
-            }
-            std::vector<uint8_t> unZipData(unZipDataSize);
-            size_t result = ZSTD_decompress(unZipData.data(), unZipData.size(), zipData.data(), zipData.size());
-            if(ZSTD_isError(result))
-            {
-                throw std::runtime_error(ZSTD_getErrorName(result));
-            }
-            return unZipData;
-        }
-        return {};
+        if(auto buffer = cache.Get(uri))
+            return buffer;
+        if(!assets.Contains(uri))
+            return nullptr;
+
+        auto buffer = std::make_shared<const std::vector<uint8_t>>(assets.GetAssetData(uri));
+        cache.Put(uri, buffer);
+        return buffer;
+    }
+
+    std::unique_ptr<AssetStream> Resource::OpenAssetStream(const String& uri)
+    {
+        return assets.OpenStream(uri);
+    }
+
+    BinaryData Resource::GetStoredAsset(const String& uri)
+    {
+        return assets.GetStored(uri);
+    }
+
+    Json Resource::GetCacheStats()
+    {
+        return cache.GetStats();
     }
 
     Json& Resource::GetConfig()
@@ -129,6 +121,7 @@ namespace ezi
         return config;
     }
 
+#if OS(WINDOWS)
     Gdiplus::Image* Resource::GetImage(const String& uri)
     {
 #if BUILDTYPE(DEBUG)
@@ -136,9 +129,9 @@ namespace ezi
 #else
         static auto origin = ("https://" + CFGRES<String>("application.package", "com.ezi.app") + "/");
         auto        data   = GetAssetData(origin + uri);
-        if(data.size() == 0)
+        if(!data || data->empty())
             return nullptr;
-        IStream* pStream = SHCreateMemStream(data.data(), static_cast<UINT>(data.size()));
+        IStream* pStream = SHCreateMemStream(data->data(), static_cast<UINT>(data->size()));
         if(!pStream)
         {
             return nullptr;
@@ -149,4 +142,5 @@ namespace ezi
         return image;
 #endif
     }
-}
\ No newline at end of file
+#endif
+}
@@ -0,0 +1,70 @@
+#include "ring.hpp"
+#include <cstring>
+
+namespace ezi
+{
+    SharedRing::SharedRing(uint8_t* base, size_t capacity) : base(base), capacity(capacity - capacity % ALIGNMENT) { }
+
+    std::optional<RingSlice> SharedRing::Write(std::span<const uint8_t> data)
+    {
+        size_t aligned = (data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if(data.empty() || aligned > capacity)
+            return std::nullopt;
+
+        RingSlice slice;
+        {
+            std::lock_guard lock(mutex);
+
+            // 尾部放不下时跳过剩余部分，保证数据连续
+            size_t position = head % capacity;
+            size_t padding  = position + aligned > capacity ? capacity - position : 0;
+            if(head + padding + aligned - tail > capacity)
+                return std::nullopt;
+
+            slice.seq    = nextSeq++;
+            slice.offset = (head + padding) % capacity;
+            slice.length = data.size();
+            head += padding + aligned;
+            records.push_back({ head, false });
+        }
+
+        // 写入区间已从空闲空间中划出，拷贝不需要持锁
+        std::memcpy(base + slice.offset, data.data(), data.size());
+        return slice;
+    }
+
+    bool SharedRing::Release(uint64_t seq)
+    {
+        std::lock_guard lock(mutex);
+
+        uint64_t first = nextSeq - records.size();
+        if(seq < first || seq >= nextSeq)
+            return false;
+        records[seq - first].released = true;
+
+        while(!records.empty() && records.front().released)
+        {
+            tail = records.front().end;
+            records.pop_front();
+        }
+        return true;
+    }
+
+    void SharedRing::Reset()
+    {
+        std::lock_guard lock(mutex);
+        records.clear();
+        tail = head;
+    }
+
+    size_t SharedRing::GetCapacity() const
+    {
+        return capacity;
+    }
+
+    size_t SharedRing::GetUsed()
+    {
+        std::lock_guard lock(mutex);
+        return head - tail;
+    }
+}
@@ -0,0 +1,72 @@
+#include "stream.hpp"
+
+namespace ezi
+{
+    ResponseStream::ResponseStream(size_t window, Sink sink, std::chrono::milliseconds timeout)
+        : sink(std::move(sink)), credits(window ? window : 1), timeout(timeout)
+    {
+    }
+
+    bool ResponseStream::Write(Object chunk)
+    {
+        uint64_t seq;
+        {
+            std::unique_lock lock(mutex);
+            auto             ready = [this] { return credits > 0 || closed; };
+            if(timeout > std::chrono::milliseconds::zero())
+            {
+                if(!condition.wait_for(lock, timeout, ready))
+                {
+                    closed   = true;
+                    timedOut = true;
+                }
+            }
+            else
+            {
+                condition.wait(lock, ready);
+            }
+            if(closed)
+                return false;
+            credits--;
+            seq = sequence++;
+        }
+        sink(seq, std::move(chunk));
+        return true;
+    }
+
+    void ResponseStream::Ack(size_t count)
+    {
+        {
+            std::lock_guard lock(mutex);
+            credits += count;
+        }
+        condition.notify_all();
+    }
+
+    void ResponseStream::Close()
+    {
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+        }
+        condition.notify_all();
+    }
+
+    bool ResponseStream::IsClosed()
+    {
+        std::lock_guard lock(mutex);
+        return closed;
+    }
+
+    bool ResponseStream::IsTimedOut()
+    {
+        std::lock_guard lock(mutex);
+        return timedOut;
+    }
+
+    uint64_t ResponseStream::GetSequence()
+    {
+        std::lock_guard lock(mutex);
+        return sequence;
+    }
+}
@@ -0,0 +1,305 @@
+#include "transport.hpp"
+#include "print.hpp"
+
+#if OS(WINDOWS)
+    #include <wrl.h>
+using namespace Microsoft::WRL;
+#endif
+
+namespace ezi
+{
+    void Transport::SetReceiver(Receiver receiver)
+    {
+        this->receiver = std::move(receiver);
+    }
+
+    void Transport::Receive(Payload payload, WireFormat format, Clock::time_point received)
+    {
+        if(receiver)
+            receiver(std::move(payload), format, received);
+    }
+
+    void Transport::Post(Job job)
+    {
+        {
+            std::lock_guard lock(mutex);
+            pending.push_back(std::move(job));
+        }
+        Wake();
+    }
+
+    void Transport::PostDelayed(Job job, std::chrono::milliseconds delay)
+    {
+        {
+            std::lock_guard lock(mutex);
+            delayed.push_back({ Clock::now() + delay, std::move(job) });
+        }
+        WakeAfter(delay);
+    }
+
+    size_t Transport::Pump()
+    {
+        std::vector<Job> jobs;
+        {
+            std::lock_guard lock(mutex);
+            jobs.swap(pending);
+
+            // 到期的延迟任务排在普通任务之后
+            auto now = Clock::now();
+            for(auto it = delayed.begin(); it != delayed.end();)
+            {
+                if(it->due > now)
+                {
+                    it++;
+                    continue;
+                }
+                jobs.push_back(std::move(it->job));
+                it = delayed.erase(it);
+            }
+        }
+        for(auto& job : jobs)
+        {
+            job();
+        }
+        return jobs.size();
+    }
+
+    SharedRing* Transport::GetRing() const
+    {
+        return ring.get();
+    }
+
+    LoopbackTransport::LoopbackTransport(Output output) : output(std::move(output)) { }
+
+    void LoopbackTransport::Deliver(std::string payload, WireFormat format)
+    {
+        auto received = Clock::now();
+        Receive(std::make_shared<const std::string>(std::move(payload)), format, received);
+    }
+
+    SendTiming LoopbackTransport::Send(const Json& message, WireFormat format)
+    {
+        SendTiming timing;
+
+        // 复用发送缓冲区，避免每条消息重新分配
+        auto started = Clock::now();
+        buffer.clear();
+        if(format == WireFormat::msgpack)
+            Json::to_msgpack(message, buffer);
+        else
+            buffer = message.dump();
+        timing.serializeNs = ElapsedNs(started);
+
+        started = Clock::now();
+        if(output)
+            output(buffer, format);
+        timing.postNs = ElapsedNs(started);
+        return timing;
+    }
+
+    bool LoopbackTransport::OpenRing(size_t capacity)
+    {
+        if(ring)
+        {
+            ring->Reset();
+            return true;
+        }
+        ringMemory.resize(capacity);
+        ring = std::make_unique<SharedRing>(ringMemory.data(), ringMemory.size());
+        return true;
+    }
+
+    const uint8_t* LoopbackTransport::GetRingMemory() const
+    {
+        return ringMemory.data();
+    }
+
+#if OS(WINDOWS)
+    namespace Private
+    {
+        // 二进制帧：每个UTF-16码元携带一个字节，免去UTF-8转码和JSON文本解析
+        // 字节偏移到U+0100起，避免0字节截断字符串
+        // WebView2的字符串消息只能传UTF-16文本，帧的传输量是msgpack字节数的两倍，与JSON文本同样按码元计；
+        // 收益来自msgpack本身比JSON文本短、编解码更快，大块二进制数据应改走共享环形缓冲区
+        static constexpr wchar_t FRAMEBASE = 0x100;
+
+        // 页面侧的帧编解码，与PackFrame、UnpackFrame对应；msgpack的编解码由页面自行完成
+        // 发送：chrome.webview.postMessage(__EziBridgeFrame.pack(bytes))
+        // 接收：message事件的data为字符串时，__EziBridgeFrame.unpack(data) 得到msgpack字节
+        // clang-format off
+        static const char* FRAMESCRIPT =
+        "window.__EziBridgeFrame=Object.freeze({"
+            "pack(bytes){"
+                "let frame='';"
+                "for(let i=0;i<bytes.length;i+=8192){"
+                    "const units=new Uint16Array(Math.min(8192,bytes.length-i));"
+                    "for(let j=0;j<units.length;j++){"
+                        "units[j]=bytes[i+j]+256;"
+                    "}"
+                    "frame+=String.fromCharCode.apply(null,units);"
+                "}"
+                "return frame;"
+            "},"
+            "unpack(frame){"
+                "const bytes=new Uint8Array(frame.length);"
+                "for(let i=0;i<frame.length;i++){"
+                    "const byte=frame.charCodeAt(i)-256;"
+                    "if(byte<0||byte>255){"
+                        "throw new Error('Invalid bridge frame');"
+                    "}"
+                    "bytes[i]=byte;"
+                "}"
+                "return bytes;"
+            "}"
+        "});";
+        // clang-format on
+
+        static std::string UnpackFrame(const wchar_t* frame)
+        {
+            std::string bytes(wcslen(frame), '\0');
+            for(size_t i = 0; i < bytes.size(); i++)
+            {
+                if(frame[i] < FRAMEBASE || frame[i] > FRAMEBASE + 0xFF)
+                    throw std::runtime_error("Invalid bridge frame");
+                bytes[i] = static_cast<char>(frame[i] - FRAMEBASE);
+            }
+            return bytes;
+        }
+
+        static constexpr UINT_PTR FRAMETIMER = 0xE21B;
+
+        static VOID CALLBACK OnFrameTimer(HWND hwnd, UINT message, UINT_PTR id, DWORD time)
+        {
+            KillTimer(hwnd, id);
+            PostMessage(hwnd, WM_EZI_BRIDGE, 0, 0);
+        }
+
+        static std::wstring PackFrame(const std::vector<uint8_t>& bytes)
+        {
+            std::wstring frame(bytes.size(), FRAMEBASE);
+            for(size_t i = 0; i < bytes.size(); i++)
+            {
+                frame[i] += bytes[i];
+            }
+            return frame;
+        }
+    }
+
+    WebViewTransport::WebViewTransport(View view, HWND winId) : view(std::move(view)), winId(winId)
+    {
+        this->view->AddScriptToExecuteOnDocumentCreated(utf8ToUtf16(Private::FRAMESCRIPT).c_str(), nullptr);
+
+        this->view->add_WebMessageReceived(
+            Callback<ICoreWebView2WebMessageReceivedEventHandler>(
+                [this](ICoreWebView2* sender, ICoreWebView2WebMessageReceivedEventArgs* args) -> HRESULT
+                {
+                    auto received = Clock::now();
+                    try
+                    {
+                        // 字符串消息为msgpack帧，对象消息为JSON
+                        // 是否接受msgpack由Bridge根据协商结果判断
+                        wil::unique_cotaskmem_string _frame;
+                        if(SUCCEEDED(args->TryGetWebMessageAsString(&_frame)))
+                        {
+                            Receive(std::make_shared<const std::string>(Private::UnpackFrame(_frame.get())),
+                                WireFormat::msgpack,
+                                received);
+                            return S_OK;
+                        }
+
+                        wil::unique_cotaskmem_string _message;
+                        args->get_WebMessageAsJson(&_message);
+                        std::wstring message(_message.get());
+
+                        Receive(std::make_shared<const std::string>(utf16ToUtf8(message)), WireFormat::json, received);
+                    }
+                    catch(const std::exception& e)
+                    {
+                        println("bridge message dropped:", e.what());
+                    }
+                    return S_OK;
+                })
+                .Get(),
+            &token);
+    }
+
+    void WebViewTransport::Wake()
+    {
+        PostMessage(winId, WM_EZI_BRIDGE, 0, 0);
+    }
+
+    void WebViewTransport::WakeAfter(std::chrono::milliseconds delay)
+    {
+        SetTimer(winId, Private::FRAMETIMER, static_cast<UINT>(delay.count()), Private::OnFrameTimer);
+    }
+
+    SendTiming WebViewTransport::Send(const Json& message, WireFormat format)
+    {
+        SendTiming timing;
+        if(!view)
+            return timing;
+
+        auto started = Clock::now();
+        if(format == WireFormat::msgpack)
+        {
+            auto frame         = Private::PackFrame(Json::to_msgpack(message));
+            timing.serializeNs = ElapsedNs(started);
+            started            = Clock::now();
+            view->PostWebMessageAsString(frame.c_str());
+            timing.postNs = ElapsedNs(started);
+            return timing;
+        }
+
+        auto utf16Response = utf8ToUtf16(message.dump());
+        timing.serializeNs = ElapsedNs(started);
+        started            = Clock::now();
+        view->PostWebMessageAsJson(utf16Response.c_str());
+        timing.postNs = ElapsedNs(started);
+        return timing;
+    }
+
+    void WebViewTransport::Close()
+    {
+        if(!view)
+            return;
+        view->remove_WebMessageReceived(token);
+        view = nullptr;
+
+        ring = nullptr;
+        if(sharedBuffer)
+        {
+            sharedBuffer->Close();
+            sharedBuffer = nullptr;
+        }
+    }
+
+    bool WebViewTransport::OpenRing(size_t capacity)
+    {
+        auto view17 = view.try_query<ICoreWebView2_17>();
+        if(!view17)
+            return false;
+
+        if(!sharedBuffer)
+        {
+            wil::com_ptr<ICoreWebView2Environment> environment;
+            if(FAILED(view.query<ICoreWebView2_2>()->get_Environment(&environment)))
+                return false;
+            auto environment12 = environment.try_query<ICoreWebView2Environment12>();
+            if(!environment12 || FAILED(environment12->CreateSharedBuffer(capacity, &sharedBuffer)))
+                return false;
+
+            BYTE* memory = nullptr;
+            sharedBuffer->get_Buffer(&memory);
+            ring = std::make_unique<SharedRing>(memory, capacity);
+        }
+        else
+        {
+            ring->Reset();
+        }
+
+        // 页面通过 chrome.webview 的 sharedbufferreceived 事件取得缓冲区
+        return SUCCEEDED(view17->PostSharedBufferToScript(
+            sharedBuffer.get(), COREWEBVIEW2_SHARED_BUFFER_ACCESS_READ_ONLY, L"{\"ezi\":\"ring\"}"));
+    }
+#endif
+}
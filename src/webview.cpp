@@ -33,6 +33,11 @@ namespace ezi
             { L".jpeg", L"image/jpeg" },
             { L".svg", L"image/svg+xml" },
             { L".json", L"application/json" },
+            { L".wasm", L"application/wasm" },
+            { L".mp4", L"video/mp4" },
+            { L".webm", L"video/webm" },
+            { L".mp3", L"audio/mpeg" },
+            { L".woff2", L"font/woff2" },
         };
 
         auto ext = PathFindExtensionW(uri.c_str());
@@ -47,6 +52,182 @@ namespace ezi
     }
 
 #if OS(WINDOWS)
+    namespace Private
+    {
+        // 把资源的[begin, end)部分包装成只读的IStream，WebView读取时才从包中取数据
+        class RangeIStream : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IStream>
+        {
+        private:
+            uint64_t begin;
+            uint64_t end;
+            uint64_t position;
+
+        protected:
+            virtual size_t ReadAt(uint64_t offset, uint8_t* out, size_t size) = 0;
+
+        public:
+            RangeIStream(uint64_t begin, uint64_t end) : begin(begin), end(end), position(begin)
+            {
+            }
+
+            HRESULT STDMETHODCALLTYPE Read(void* buffer, ULONG size, ULONG* read) override
+            {
+                size_t count = 0;
+                try
+                {
+                    size_t wanted = static_cast<size_t>(std::min<uint64_t>(size, end - position));
+                    count         = ReadAt(position, static_cast<uint8_t*>(buffer), wanted);
+                }
+                catch(const std::exception&)
+                {
+                    return E_FAIL;
+                }
+                position += count;
+                if(read)
+                    *read = static_cast<ULONG>(count);
+                return count < size ? S_FALSE : S_OK;
+            }
+
+            HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER move, DWORD origin, ULARGE_INTEGER* newPosition) override
+            {
+                int64_t base = origin == STREAM_SEEK_SET   ? 0
+                               : origin == STREAM_SEEK_CUR ? static_cast<int64_t>(position - begin)
+                                                           : static_cast<int64_t>(end - begin);
+                int64_t target = base + move.QuadPart;
+                if(target < 0)
+                    return STG_E_INVALIDFUNCTION;
+                position = begin + std::min<uint64_t>(target, end - begin);
+                if(newPosition)
+                    newPosition->QuadPart = position - begin;
+                return S_OK;
+            }
+
+            HRESULT STDMETHODCALLTYPE Stat(STATSTG* stat, DWORD flag) override
+            {
+                *stat                 = {};
+                stat->type            = STGTY_STREAM;
+                stat->cbSize.QuadPart = end - begin;
+                stat->grfMode         = STGM_READ;
+                return S_OK;
+            }
+
+            HRESULT STDMETHODCALLTYPE Write(const void*, ULONG, ULONG*) override { return STG_E_ACCESSDENIED; }
+            HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER) override { return E_NOTIMPL; }
+            HRESULT STDMETHODCALLTYPE CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*) override
+            {
+                return E_NOTIMPL;
+            }
+            HRESULT STDMETHODCALLTYPE Commit(DWORD) override { return E_NOTIMPL; }
+            HRESULT STDMETHODCALLTYPE Revert() override { return E_NOTIMPL; }
+            HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+            HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+            HRESULT STDMETHODCALLTYPE Clone(IStream**) override { return E_NOTIMPL; }
+        };
+
+        // 分帧存放的资源，读取时只解压涉及的帧
+        class AssetIStream : public RangeIStream
+        {
+        private:
+            std::unique_ptr<AssetStream> stream;
+
+        protected:
+            size_t ReadAt(uint64_t offset, uint8_t* out, size_t size) override
+            {
+                return stream->ReadAt(offset, out, size);
+            }
+
+        public:
+            AssetIStream(std::unique_ptr<AssetStream> stream, uint64_t begin, uint64_t end)
+                : RangeIStream(begin, end), stream(std::move(stream))
+            {
+            }
+        };
+
+        // 直接存放的资源，从包内的数据复制到WebView的缓冲区，中间没有解压和额外的副本
+        class StoredIStream : public RangeIStream
+        {
+        private:
+            BinaryData data;
+
+        protected:
+            size_t ReadAt(uint64_t offset, uint8_t* out, size_t size) override
+            {
+                size = static_cast<size_t>(std::min<uint64_t>(size, data.size() - offset));
+                std::memcpy(out, data.data() + offset, size);
+                return size;
+            }
+
+        public:
+            StoredIStream(BinaryData data, uint64_t begin, uint64_t end) : RangeIStream(begin, end), data(data)
+            {
+            }
+        };
+
+        static String GetRangeHeader(ICoreWebView2WebResourceRequest* request)
+        {
+            wil::com_ptr<ICoreWebView2HttpRequestHeaders> headers;
+            BOOL                                          contains = FALSE;
+            if(FAILED(request->get_Headers(&headers)) || FAILED(headers->Contains(L"Range", &contains)) || !contains)
+                return "";
+            wil::unique_cotaskmem_string value;
+            if(FAILED(headers->GetHeader(L"Range", &value)))
+                return "";
+            return utf16ToUtf8(value.get());
+        }
+
+        // 支持单个范围的Range请求，便于视频拖动和wasm流式编译
+        static wil::com_ptr<ICoreWebView2WebResourceResponse> CreateAssetResponse(
+            ICoreWebView2Environment* env, const std::wstring& uri, ICoreWebView2WebResourceRequest* request)
+        {
+            String                                         url      = utf16ToUtf8(uri);
+            auto&                                          resource = Resource::GetInstance();
+            wil::com_ptr<ICoreWebView2WebResourceResponse> response;
+
+            // 直接存放的资源引用包内的数据，分帧存放的大资源按需解压，其余资源从缓存取得整块数据
+            BinaryData                   stored = resource.GetStoredAsset(url);
+            std::unique_ptr<AssetStream> stream = stored.empty() ? resource.OpenAssetStream(url) : nullptr;
+            AssetBuffer                  buffer = stored.empty() && !stream ? resource.GetAssetData(url) : nullptr;
+            if(stored.empty() && !stream && (!buffer || buffer->empty()))
+            {
+                env->CreateWebResourceResponse(nullptr, 404, L"Not Found", nullptr, &response);
+                return response;
+            }
+
+            uint64_t    length = !stored.empty() ? stored.size() : stream ? stream->GetLength() : buffer->size();
+            ByteRange   range  = { 0, length };
+            RangeResult result = ParseByteRange(GetRangeHeader(request), length, range);
+            if(result == RangeResult::unsatisfiable)
+            {
+                std::wstring headers = L"Content-Range: bytes */" + std::to_wstring(length);
+                env->CreateWebResourceResponse(nullptr, 416, L"Range Not Satisfiable", headers.c_str(), &response);
+                return response;
+            }
+
+            wil::com_ptr<IStream> content;
+            if(!stored.empty())
+                content = Make<StoredIStream>(stored, range.begin, range.end).Get();
+            else if(stream)
+                content = Make<AssetIStream>(std::move(stream), range.begin, range.end).Get();
+            else
+                content.attach(
+                    SHCreateMemStream(buffer->data() + range.begin, static_cast<UINT>(range.end - range.begin)));
+
+            // 长度由WebView2从流的Stat取得，不另外给出Content-Length
+            std::wstring headers = L"Content-Type: " + GetMimeType(uri) + L"\r\nAccept-Ranges: bytes";
+            if(result == RangeResult::partial)
+            {
+                headers += L"\r\nContent-Range: bytes " + std::to_wstring(range.begin) + L"-"
+                           + std::to_wstring(range.end - 1) + L"/" + std::to_wstring(length);
+                env->CreateWebResourceResponse(content.get(), 206, L"Partial Content", headers.c_str(), &response);
+            }
+            else
+            {
+                env->CreateWebResourceResponse(content.get(), 200, L"OK", headers.c_str(), &response);
+            }
+            return response;
+        }
+    }
+
     void Webview::CreateEnv()
     {
         auto options = Make<CoreWebView2EnvironmentOptions>();
@@ -253,24 +434,7 @@ namespace ezi
                         String url = utf16ToUtf8(uri.get());
                         println("WebResourceRequested", url);
 
-                        auto assetsBinarys = Resource::GetInstance().GetAssetData(url);
-
-                        ULONG written = 0;
-
-                        wil::com_ptr<ICoreWebView2WebResourceResponse> response;
-                        if(assetsBinarys.size() > 0)
-                        {
-                            std::wstring          mime = GetMimeType(uri.get());
-                            wil::com_ptr<IStream> stream
-                                = SHCreateMemStream(assetsBinarys.data(), assetsBinarys.size());
-                            this->env->CreateWebResourceResponse(
-                                stream.get(), 200, L"OK", (L"Content-Type: " + mime).c_str(), &response);
-                        }
-                        else
-                        {
-                            this->env->CreateWebResourceResponse(nullptr, 404, L"Not Found", nullptr, &response);
-                        }
-
+                        auto response = Private::CreateAssetResponse(this->env.get(), uri.get(), request.get());
                         args->put_Response(response.get());
                         return S_OK;
                     })
@@ -365,6 +529,17 @@ namespace ezi
                     .Get(),
                 nullptr);
 
+            // 页面跳转前取消旧页面进行中的调用
+            view->add_NavigationStarting(
+                Callback<ICoreWebView2NavigationStartingEventHandler>(
+                    [&window](ICoreWebView2* sender, ICoreWebView2NavigationStartingEventArgs* args) -> HRESULT
+                    {
+                        Bridge::GetInstance().CancelWindow(window.GetWinId());
+                        return S_OK;
+                    })
+                    .Get(),
+                nullptr);
+
             // 导航结束处理
             view->add_NavigationCompleted(
                 Callback<ICoreWebView2NavigationCompletedEventHandler>(
@@ -453,7 +628,7 @@ namespace ezi
             window.SetController(controller);
             window.SetView(view);
             auto& bridge = Bridge::GetInstance();
-            bridge.ExposeTo(view, window.GetWinId());
+            bridge.ExposeTo(view, window.GetWinId(), Bridge::ParseWireFormat(window.GetBridgeFormat()));
             view->Navigate(utf8ToUtf16(window.GetUrl().c_str()).c_str());
             return S_OK;
         };
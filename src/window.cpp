@@ -13,6 +13,7 @@ using namespace Gdiplus;
 
 #include "resource.hpp"
 #include "dialog.hpp"
+#include "bridge.hpp"
 
 namespace ezi
 {
@@ -26,6 +27,11 @@ namespace ezi
             DwmSetWindowAttribute(hwnd, DWMWA_USE_IMMERSIVE_DARK_MODE, &isDark, sizeof(isDark));
         }
 
+        static String ToWinIdString(HWND hwnd)
+        {
+            return std::to_string(reinterpret_cast<uintptr_t>(hwnd));
+        }
+
         static void DrawSplashScreen(Graphics& graphics, Window& window)
         {
             auto& splash = window.GetSplash();
@@ -132,6 +138,44 @@ namespace ezi
                         .c_str(),
                     nullptr);
             }
+            Bridge::GetInstance().Emit("theme.changed",
+                {
+                    { "winId", Private::ToWinIdString(hwnd) },
+                    { "dark", Utils::IsDarkMode() },
+                    { "accentColor", Utils::ColorRefToHex(Utils::GetAccentColor()) },
+                },
+                hwnd);
+            break;
+        }
+        case WM_MOVE:
+        {
+            if(!window)
+                break;
+            Position pos = window->GetPosition();
+            Bridge::GetInstance().Emit("window.moved",
+                {
+                    { "winId", Private::ToWinIdString(hwnd) },
+                    { "x", pos.x },
+                    { "y", pos.y },
+                });
+            break;
+        }
+        case WM_ACTIVATE:
+        {
+            Bridge::GetInstance().Emit("window.focusChanged",
+                {
+                    { "winId", Private::ToWinIdString(hwnd) },
+                    { "focused", LOWORD(wParam) != WA_INACTIVE },
+                });
+            break;
+        }
+        case WM_SHOWWINDOW:
+        {
+            Bridge::GetInstance().Emit("window.visibilityChanged",
+                {
+                    { "winId", Private::ToWinIdString(hwnd) },
+                    { "visible", wParam == TRUE },
+                });
             break;
         }
         case WM_PAINT:
@@ -198,8 +242,16 @@ namespace ezi
             break;
         }
 
+        case WM_EZI_BRIDGE:
+        {
+            Bridge::GetInstance().Pump(hwnd);
+            return 0;
+        }
+
         case WM_DESTROY:
         {
+            Bridge::GetInstance().Detach(hwnd);
+            Bridge::GetInstance().Emit("window.closed", { { "winId", Private::ToWinIdString(hwnd) } });
             Application::GetInstance().DelWindowById(hwnd);
             return 0;
         }
@@ -213,6 +265,16 @@ namespace ezi
                 GetClientRect(hwnd, &bounds);
                 controller->put_Bounds(bounds);
             }
+
+            Size   size  = window->GetSize();
+            String state = wParam == SIZE_MAXIMIZED ? "maximized" : (wParam == SIZE_MINIMIZED ? "minimized" : "normal");
+            Bridge::GetInstance().Emit("window.resized",
+                {
+                    { "winId", Private::ToWinIdString(hwnd) },
+                    { "width", size.width },
+                    { "height", size.height },
+                    { "state", state },
+                });
             break;
         }
         }
@@ -330,6 +392,9 @@ namespace ezi
         // 强调色
         accentColor = at<String>(options, "accentColor", "system");
 
+        // 桥接消息允许协商的最高格式
+        bridgeFormat = at<String>(options, "bridgeFormat", "msgpack");
+
         // 获取splash配置
         String defaultSplashSrc = CFGRES<String>("window.splashscreen.src", "logo.png");
 
@@ -385,6 +450,11 @@ namespace ezi
         if(winId)
         {
             SetWindowText(winId, utf8ToGbk(title).c_str());
+            Bridge::GetInstance().Emit("window.titleChanged",
+                {
+                    { "winId", Private::ToWinIdString(winId) },
+                    { "title", title },
+                });
         }
     }
 
@@ -721,6 +791,11 @@ namespace ezi
         return this->accentColor;
     }
 
+    String Window::GetBridgeFormat() const
+    {
+        return this->bridgeFormat;
+    }
+
     Splash& Window::GetSplash()
     {
         return this->splash;
@@ -0,0 +1,90 @@
+#include "workers.hpp"
+
+namespace ezi
+{
+    WorkerPool::WorkerPool(size_t size, std::chrono::milliseconds aging) : aging(aging)
+    {
+        if(size == 0)
+            size = 1;
+        threads.reserve(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            threads.emplace_back([this] { Loop(); });
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::Loop()
+    {
+        while(true)
+        {
+            Job job;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this] { return stopping || HasJobs(); });
+                if(stopping && !HasJobs())
+                    return;
+                job = Take();
+            }
+            job();
+        }
+    }
+
+    Job WorkerPool::Take()
+    {
+        size_t pick = 0;
+        while(jobs[pick].empty())
+        {
+            pick++;
+        }
+        // 已等待超过时限的低优先级任务优先
+        auto now = std::chrono::steady_clock::now();
+        for(size_t i = pick + 1; i < jobs.size(); i++)
+        {
+            if(!jobs[i].empty() && now - jobs[i].front().queued >= aging)
+            {
+                pick = i;
+                break;
+            }
+        }
+        Job job = std::move(jobs[pick].front().job);
+        jobs[pick].pop_front();
+        return job;
+    }
+
+    bool WorkerPool::HasJobs() const
+    {
+        for(auto& queue : jobs)
+        {
+            if(!queue.empty())
+                return true;
+        }
+        return false;
+    }
+
+    void WorkerPool::Submit(Job job, Priority priority)
+    {
+        {
+            std::lock_guard lock(mutex);
+            jobs[static_cast<size_t>(priority)].push_back({ std::move(job), std::chrono::steady_clock::now() });
+        }
+        condition.notify_one();
+    }
+
+    size_t WorkerPool::GetSize() const
+    {
+        return threads.size();
+    }
+}
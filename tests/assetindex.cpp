@@ -0,0 +1,61 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "assetindex.hpp"
+#include "check.hpp"
+
+using namespace ezi;
+
+TEST_CASE(AssetIndexFind)
+{
+    std::vector<std::pair<String, AssetMeta>> entries;
+    std::vector<std::pair<String, AssetMeta>> dictionaries = { { "dict", { 0, 16 } } };
+    for(size_t i = 0; i < 100; i++)
+    {
+        AssetMeta meta { 16 + i * 8, 8 };
+        meta.dictionary = i % 2 ? 0 : -1;
+        meta.seekable   = i % 5 == 1;
+        meta.stored     = i % 3 == 0;
+        entries.emplace_back("https://app/" + std::to_string(i) + ".js", meta);
+    }
+
+    std::vector<uint8_t> pack(16 + 100 * 8, 0);
+    auto                 index = AssetIndex::Build(entries, dictionaries);
+    pack.insert(pack.end(), index.begin(), index.end());
+    CHECK(AssetIndex::Has(BinaryData(pack)));
+
+    AssetIndex assets { BinaryData(pack) };
+    CHECK(assets.GetCount() == 100);
+    CHECK(assets.GetDictionaryCount() == 1);
+    CHECK(assets.GetDictionaryName(0) == "dict");
+    for(auto& [uri, meta] : entries)
+    {
+        auto found = assets.Find(uri);
+        CHECK(found.has_value());
+        if(!found)
+            continue;
+        CHECK(found->offset == meta.offset);
+        CHECK(found->size == meta.size);
+        CHECK(found->dictionary == meta.dictionary);
+        CHECK(found->seekable == meta.seekable);
+        CHECK(found->stored == meta.stored);
+    }
+    CHECK(!assets.Find("https://app/100.js"));
+    CHECK(!assets.Find(""));
+}
+
+TEST_CASE(AssetIndexRejectsDuplicates)
+{
+    std::vector<std::pair<String, AssetMeta>> entries = { { "a", { 0, 1 } }, { "a", { 1, 1 } } };
+    bool                                      threw   = false;
+    try
+    {
+        AssetIndex::Build(entries, {});
+    }
+    catch(const std::runtime_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+}
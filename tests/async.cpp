@@ -0,0 +1,114 @@
+#include <future>
+#include <thread>
+
+#include "check.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    Task Twice(int value)
+    {
+        co_return value * 2;
+    }
+
+    // 参数复制进协程帧，帧释放时引用计数随之减少
+    Task Hold(std::shared_ptr<int> sentinel)
+    {
+        co_return *sentinel;
+    }
+}
+
+TEST_CASE(AsyncTaskCompletesOnPool)
+{
+    auto&             bridge    = Bridge::GetInstance();
+    auto              caller    = std::this_thread::get_id();
+    std::atomic<bool> offThread = false;
+    bridge.RegisterAsync("test.async.twice",
+        [&offThread, caller](Object args) -> Task
+        {
+            offThread = std::this_thread::get_id() != caller;
+            // 协程内可以等待其他Task
+            co_return co_await Twice(args["n"].get<int>());
+        });
+
+    Test::Page page(0x1001);
+    auto       result = page.Call(1, "test.async.twice", { { "n", 21 } });
+    CHECK(result && *result == 42);
+    CHECK(offThread);
+}
+
+TEST_CASE(AsyncFutureCompletesOnPool)
+{
+    auto& bridge = Bridge::GetInstance();
+    bridge.RegisterAsync("test.async.future",
+        [](Object args) { return std::async(std::launch::async, [args] { return Object(args["text"]); }); });
+
+    Test::Page page(0x1002);
+    auto       result = page.Call("f", "test.async.future", { { "text", "done" } });
+    CHECK(result && *result == "done");
+}
+
+TEST_CASE(AsyncUnknownExceptionIsInternal)
+{
+    auto& bridge = Bridge::GetInstance();
+    // 协程内抛出的非标准异常在完成回调中转为internal错误
+    bridge.RegisterAsync("test.async.throwInside",
+        [](Object args) -> Task
+        {
+            if(args.is_object())
+                throw 42;
+            co_return nullptr;
+        });
+    // 创建协程之前抛出的异常在派发时转为internal错误
+    bridge.RegisterAsync("test.async.throwBefore", [](Object) -> Task { throw 42; });
+
+    Test::Page page(0x1003);
+    for(auto func : { "test.async.throwInside", "test.async.throwBefore" })
+    {
+        auto result = page.Call(func, func);
+        CHECK(result && result->value("code", "") == "internal");
+        CHECK(result && result->value("error", "") == "Unknown error");
+    }
+
+    auto result = page.Call("std", "test.async.throwInside", Json::array());
+    CHECK(result && *result == nullptr);
+}
+
+TEST_CASE(AsyncCallFromNative)
+{
+    auto& bridge = Bridge::GetInstance();
+    bridge.RegisterAsync("test.async.native", [](Object args) -> Task { co_return args.size(); });
+
+    std::promise<Json> promise;
+    bridge.CallAsync("test.async.native",
+        Json::array({ 1, 2, 3 }),
+        [&promise](Json result) { promise.set_value(std::move(result)); });
+    auto future = promise.get_future();
+    CHECK(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    CHECK(future.get() == 3);
+}
+
+TEST_CASE(AsyncFrameReleasedWhenDropped)
+{
+    auto& bridge   = Bridge::GetInstance();
+    auto  sentinel = std::make_shared<int>(7);
+    bridge.RegisterAsync("test.async.hold", [sentinel](Object) { return Hold(sentinel); });
+
+    Test::Page page(0x1004);
+    auto       result = page.Call(1, "test.async.hold");
+    CHECK(result && *result == 7);
+    // 完成后工作线程随即释放协程帧
+    auto deadline = Clock::now() + std::chrono::seconds(1);
+    while(sentinel.use_count() > 2 && Clock::now() < deadline)
+        std::this_thread::yield();
+    CHECK(sentinel.use_count() == 2);
+
+    // 没有进入队列的任务连同协程帧一起释放
+    bridge.SetQueueLimit(0);
+    result = page.Call(2, "test.async.hold");
+    bridge.SetQueueLimit(64);
+    CHECK(result && result->value("code", "") == "backpressure");
+    CHECK(sentinel.use_count() == 2);
+}
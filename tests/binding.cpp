@@ -0,0 +1,109 @@
+#include <optional>
+
+#include "check.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    int Add(int a, int b)
+    {
+        return a + b;
+    }
+
+    String Repeat(const String& text, std::optional<int> times)
+    {
+        String result;
+        for(int i = 0; i < times.value_or(1); i++)
+            result += text;
+        return result;
+    }
+
+    String Label(const CallContext& context, const String& prefix)
+    {
+        return prefix + std::to_string(reinterpret_cast<uintptr_t>(context.sender));
+    }
+
+    void Ignore(const Json&) { }
+
+    // 以绑定后的处理函数执行，返回结果或错误的json
+    template <typename Handler> Json Run(Handler& handler, Json args, const CallContext& context = {})
+    {
+        Envelope envelope(std::move(args));
+        try
+        {
+            return handler(context, envelope);
+        }
+        catch(const BridgeError& e)
+        {
+            return e.ToJson();
+        }
+    }
+}
+
+TEST_CASE(BindingDecodesArguments)
+{
+    auto add = Binding::Bind(Add, { "a", "b" });
+    CHECK(Run(add, { { "a", 1 }, { "b", 2 } }) == 3);
+
+    auto repeat = Binding::Bind(Repeat, { "text", "times" });
+    CHECK(Run(repeat, { { "text", "ab" }, { "times", 3 } }) == "ababab");
+    // 可选参数缺省或为null时为空
+    CHECK(Run(repeat, { { "text", "ab" } }) == "ab");
+    CHECK(Run(repeat, { { "text", "ab" }, { "times", nullptr } }) == "ab");
+
+    // CallContext参数不占用参数名
+    auto label = Binding::Bind(Label, { "prefix" });
+    CHECK(Run(label, { { "prefix", "win" } }, { reinterpret_cast<WinId>(7), {} }) == "win7");
+
+    // 无返回值的函数回复success
+    auto ignore = Binding::Bind(Ignore, { "value" });
+    CHECK(Run(ignore, { { "value", Json::array() } }) == "success");
+}
+
+TEST_CASE(BindingMissingArgument)
+{
+    auto add    = Binding::Bind(Add, { "a", "b" });
+    Json result = Run(add, { { "a", 1 } });
+    CHECK(result.value("code", "") == "missing_argument");
+    CHECK(result.value("argument", "") == "b");
+
+    auto repeat = Binding::Bind(Repeat, { "text", "times" });
+    result      = Run(repeat, Json::object());
+    CHECK(result.value("code", "") == "missing_argument");
+    CHECK(result.value("argument", "") == "text");
+}
+
+TEST_CASE(BindingWrongType)
+{
+    auto add    = Binding::Bind(Add, { "a", "b" });
+    Json result = Run(add, { { "a", 1 }, { "b", "two" } });
+    CHECK(result.value("code", "") == "invalid_argument");
+    CHECK(result.value("argument", "") == "b");
+
+    // 按引用解码的字符串参数同样检查类型
+    auto repeat = Binding::Bind(Repeat, { "text", "times" });
+    result      = Run(repeat, { { "text", 5 } });
+    CHECK(result.value("code", "") == "invalid_argument");
+    CHECK(result.value("argument", "") == "text");
+
+    result = Run(repeat, { { "text", "ab" }, { "times", "3" } });
+    CHECK(result.value("code", "") == "invalid_argument");
+    CHECK(result.value("argument", "") == "times");
+}
+
+TEST_CASE(BindingErrorsReachPage)
+{
+    auto& bridge = Bridge::GetInstance();
+    bridge.Register("test.binding.add", Add, "a", "b");
+
+    Test::Page page(0x4001);
+    auto       result = page.Call(1, "test.binding.add", { { "a", 2 }, { "b", 3 } });
+    CHECK(result && *result == 5);
+
+    result = page.Call(2, "test.binding.add", { { "a", 2 } });
+    CHECK(result && result->value("code", "") == "missing_argument");
+    result = page.Call(3, "test.binding.add", { { "a", 2 }, { "b", Json::array() } });
+    CHECK(result && result->value("code", "") == "invalid_argument");
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "check.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+TEST_CASE(CancelReachesRunningHandler)
+{
+    auto&             bridge  = Bridge::GetInstance();
+    std::atomic<bool> started = false;
+    bridge.RegisterAsync("test.cancel.wait",
+        [&started](CallContext context, Object) -> Task
+        {
+            started = true;
+            // 取消时返回true，超时返回false
+            co_return context.token.WaitFor(std::chrono::seconds(5));
+        });
+
+    Test::Page page(0xD001);
+    page.Send({ { "id", "run" }, { "func", "test.cancel.wait" } });
+    while(!started)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto start     = Clock::now();
+    auto cancelled = page.Call("cancel", "bridge.cancel", { { "id", "run" } });
+    CHECK(cancelled && *cancelled == true);
+    auto reply = page.WaitFor("run");
+    CHECK(reply && (*reply)["result"] == true);
+    CHECK(Clock::now() - start < std::chrono::seconds(1));
+
+    // 已结束或不存在的调用
+    cancelled = page.Call("again", "bridge.cancel", { { "id", "run" } });
+    CHECK(cancelled && *cancelled == false);
+}
+
+TEST_CASE(CancelWindowReachesRunningHandler)
+{
+    auto&             bridge  = Bridge::GetInstance();
+    std::atomic<bool> started = false;
+    bridge.RegisterAsync("test.cancel.window",
+        [&started](CallContext context, Object) -> Task
+        {
+            started = true;
+            co_return context.token.WaitFor(std::chrono::seconds(5));
+        });
+
+    Test::Page page(0xD002);
+    page.Send({ { "id", 1 }, { "func", "test.cancel.window" } });
+    while(!started)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    bridge.CancelWindow(page.GetId());
+    auto reply = page.WaitFor(1, std::chrono::seconds(1));
+    CHECK(reply && (*reply)["result"] == true);
+}
+
+TEST_CASE(CancelDropsQueuedCall)
+{
+    auto&             bridge = Bridge::GetInstance();
+    std::atomic<bool> open   = false;
+    std::mutex        mutex;
+    std::set<int>     ran;
+    bridge.RegisterAsync("test.cancel.queued",
+        [&](Object args) -> Task
+        {
+            {
+                std::lock_guard lock(mutex);
+                ran.insert(args["n"].get<int>());
+            }
+            while(!open)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            co_return true;
+        });
+
+    // 占满工作线程，直到有调用留在队列中
+    Test::Page page(0xD003);
+    String     key  = std::to_string(reinterpret_cast<uintptr_t>(page.GetId()));
+    int        sent = 0;
+    for(; sent < 512; sent++)
+    {
+        page.Send({ { "id", sent }, { "func", "test.cancel.queued" }, { "args", { { "n", sent } } } });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        if(bridge.GetQueueStats()["windows"].value(key, 0) > 0)
+            break;
+    }
+    int queued = sent;
+    CHECK(queued < 512);
+
+    auto cancelled = page.Call("cancel", "bridge.cancel", { { "id", queued } });
+    CHECK(cancelled && *cancelled == true);
+
+    open = true;
+    auto reply = page.WaitFor(queued);
+    CHECK(reply && (*reply)["result"].value("code", "") == "cancelled");
+    for(int id = 0; id < queued; id++)
+    {
+        reply = page.WaitFor(id);
+        CHECK(reply && (*reply)["result"] == true);
+    }
+
+    // 排队期间取消的调用没有执行
+    std::lock_guard lock(mutex);
+    CHECK(!ran.contains(queued));
+    CHECK(ran.size() == static_cast<size_t>(queued));
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+namespace ezi::Test
+{
+    // 测试用例在静态初始化时登记，由 tests/main.cpp 依次运行
+    struct Case
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    inline std::vector<Case>& GetCases()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    // 检查也可能在工作线程上进行
+    inline std::atomic<int> failures = 0;
+
+    struct Registrar
+    {
+        Registrar(const char* name, void (*run)())
+        {
+            GetCases().push_back({ name, run });
+        }
+    };
+}
+
+#define TEST_CASE(name)                                                                                                \
+    static void                 name();                                                                                \
+    static ezi::Test::Registrar name##Registrar(#name, name);                                                          \
+    static void                 name()
+
+#define CHECK(condition)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if(!(condition))                                                                                               \
+        {                                                                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                         \
+            ezi::Test::failures++;                                                                                     \
+        }                                                                                                              \
+    } while(0)
@@ -0,0 +1,85 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "envelope.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    Payload MakePayload(std::string text)
+    {
+        return std::make_shared<const std::string>(std::move(text));
+    }
+}
+
+TEST_CASE(EnvelopeSkipsUnknownJsonFields)
+{
+    // 未知字段跳过，包括嵌套的对象、数组和含有转义的字符串
+    std::vector<Envelope> calls;
+    auto                  payload = MakePayload(R"({"trace": {"a": [1, {"b": "}]"}]}, "id": 7, "note": "x\"}", )"
+                                                R"("func": "ping", "args": {"n": 1}, "tail": null})");
+    CHECK(!Envelope::Open(payload, WireFormat::json, calls));
+    CHECK(calls.size() == 1);
+    if(calls.size() == 1)
+    {
+        CHECK(calls[0].GetId() == 7);
+        CHECK(calls[0].GetFunc() == "ping");
+        // args保留为原始片段，读取时才解析
+        CHECK(calls[0].GetRawArgs() == R"({"n": 1})");
+        CHECK(calls[0].GetArgs()["n"] == 1);
+    }
+
+    calls.clear();
+    CHECK(Envelope::Open(MakePayload(R"([{"x": 1, "func": "a"}, {}, {"func": "b", "y": [2]}])"),
+        WireFormat::json,
+        calls));
+    CHECK(calls.size() == 3);
+    if(calls.size() == 3)
+    {
+        CHECK(calls[0].GetFunc() == "a");
+        CHECK(calls[1].GetFunc().is_null());
+        CHECK(calls[2].GetFunc() == "b");
+    }
+}
+
+TEST_CASE(EnvelopeSkipsUnknownMsgpackFields)
+{
+    Json message = {
+        { "extra", { { "deep", Json::array({ 1, "two", 3.5, nullptr }) } } },
+        { "id", 42 },
+        { "blob", Json::binary({ 1, 2, 3 }) },
+        { "func", "echo" },
+        { "args", { { "text", "hi" } } },
+    };
+    auto                  packed = Json::to_msgpack(message);
+    std::vector<Envelope> calls;
+    CHECK(!Envelope::Open(MakePayload(std::string(packed.begin(), packed.end())), WireFormat::msgpack, calls));
+    CHECK(calls.size() == 1);
+    if(calls.size() == 1)
+    {
+        CHECK(calls[0].GetId() == 42);
+        CHECK(calls[0].GetFunc() == "echo");
+        CHECK(calls[0].GetArgs()["text"] == "hi");
+    }
+}
+
+TEST_CASE(EnvelopeRejectsMalformed)
+{
+    std::vector<Envelope> calls;
+    for(auto text : { R"({"id": 1, "func": )", R"({"id" 1})", R"([{"id": 1},)", "" })
+    {
+        bool threw = false;
+        try
+        {
+            Envelope::Open(MakePayload(text), WireFormat::json, calls);
+        }
+        catch(const std::exception&)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
@@ -0,0 +1,34 @@
+// ezi_tests：核心模块的单元测试，由 ctest 运行，任一检查失败时返回非零
+// 用法：ezi_tests [用例名...]，不给出用例名时运行全部用例
+#include <cstring>
+
+#include "check.hpp"
+
+int main(int argc, char** argv)
+{
+    int ran = 0;
+    for(auto& test : ezi::Test::GetCases())
+    {
+        bool selected = argc < 2;
+        for(int i = 1; i < argc; i++)
+        {
+            if(!std::strcmp(argv[i], test.name))
+                selected = true;
+        }
+        if(!selected)
+            continue;
+
+        int before = ezi::Test::failures;
+        test.run();
+        std::printf("%-40s %s\n", test.name, ezi::Test::failures == before ? "ok" : "FAILED");
+        ran++;
+    }
+
+    if(ezi::Test::failures)
+    {
+        std::fprintf(stderr, "%d checks failed\n", ezi::Test::failures.load());
+        return 1;
+    }
+    std::printf("%d cases passed\n", ran);
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "check.hpp"
+#include "memo.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    constexpr auto LONG = std::chrono::seconds(10);
+
+    // 以键为结果，记录实际执行的次数
+    Json Get(MemoCache&            memo,
+        const std::string&        key,
+        std::atomic<int>&         computed,
+        bool&                     hit,
+        std::chrono::milliseconds ttl = LONG)
+    {
+        return memo.Get(
+            "f",
+            key,
+            ttl,
+            [&]
+            {
+                computed++;
+                return Json(key);
+            },
+            hit);
+    }
+}
+
+TEST_CASE(MemoSharesInflightCall)
+{
+    MemoCache         memo;
+    std::atomic<int>  computed = 0;
+    std::atomic<bool> entered  = false;
+    std::atomic<bool> open     = false;
+    auto              compute  = [&]
+    {
+        computed++;
+        entered = true;
+        while(!open)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return Json(42);
+    };
+
+    Json        first;
+    bool        firstHit = true;
+    std::thread owner([&] { first = memo.Get("f", "k", LONG, compute, firstHit); });
+    while(!entered)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // 执行中的相同调用等待同一个结果
+    Json        second;
+    bool        secondHit = false;
+    std::thread waiter([&] { second = memo.Get("f", "k", LONG, compute, secondHit); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    open = true;
+    owner.join();
+    waiter.join();
+
+    CHECK(computed == 1);
+    CHECK(first == 42 && second == 42);
+    CHECK(!firstHit && secondHit);
+}
+
+TEST_CASE(MemoExpiresAfterTtl)
+{
+    MemoCache        memo;
+    std::atomic<int> computed = 0;
+    bool             hit      = true;
+    auto             ttl      = std::chrono::milliseconds(20);
+
+    CHECK(Get(memo, "k", computed, hit, ttl) == "k" && !hit);
+    CHECK(Get(memo, "k", computed, hit, ttl) == "k" && hit);
+    CHECK(computed == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    CHECK(Get(memo, "k", computed, hit, ttl) == "k" && !hit);
+    CHECK(computed == 2);
+}
+
+TEST_CASE(MemoInvalidatedByTopic)
+{
+    MemoCache        memo;
+    std::atomic<int> computed = 0;
+    bool             hit      = true;
+    memo.SetTopics("f", { "changed" });
+
+    Get(memo, "k", computed, hit);
+    memo.Invalidate("other");
+    Get(memo, "k", computed, hit);
+    CHECK(hit && computed == 1);
+
+    memo.Invalidate("changed");
+    Get(memo, "k", computed, hit);
+    CHECK(!hit && computed == 2);
+
+    // 执行期间发生失效时结果照常返回，但不缓存
+    Json result = memo.Get(
+        "f",
+        "during",
+        LONG,
+        [&]
+        {
+            memo.Invalidate("changed");
+            return Json("stale");
+        },
+        hit);
+    CHECK(result == "stale" && !hit);
+    CHECK(Get(memo, "during", computed, hit) == "during" && !hit);
+}
+
+TEST_CASE(MemoReentrantCallComputesDirectly)
+{
+    MemoCache memo;
+    int       depth = 0;
+    bool      hit   = true;
+
+    // 处理函数在执行中以相同参数调用自己，不等待自身的结果
+    std::function<Json()> compute = [&]() -> Json
+    {
+        if(++depth < 3)
+        {
+            bool inner = true;
+            Json value = memo.Get("f", "k", LONG, compute, inner);
+            CHECK(!inner);
+            return value.get<int>() + 1;
+        }
+        return 1;
+    };
+    CHECK(memo.Get("f", "k", LONG, compute, hit) == 3);
+    CHECK(!hit && depth == 3);
+
+    // 最外层的结果被缓存
+    CHECK(memo.Get("f", "k", LONG, compute, hit) == 3);
+    CHECK(hit && depth == 3);
+}
+
+TEST_CASE(MemoDoesNotCacheErrors)
+{
+    MemoCache memo;
+    int       calls = 0;
+    bool      hit   = true;
+    auto      fail  = [&]() -> Json
+    {
+        calls++;
+        throw std::runtime_error("failed");
+    };
+
+    for(int i = 0; i < 2; i++)
+    {
+        bool threw = false;
+        try
+        {
+            memo.Get("f", "k", LONG, fail, hit);
+        }
+        catch(const std::runtime_error&)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+    CHECK(calls == 2);
+}
+
+TEST_CASE(MemoBoundsSlots)
+{
+    MemoCache        memo;
+    std::atomic<int> computed = 0;
+    bool             hit      = true;
+
+    // 满时先移除过期的结果，未过期的保留
+    for(int i = 0; i < 128; i++)
+        Get(memo, "short" + std::to_string(i), computed, hit, std::chrono::milliseconds(10));
+    for(int i = 0; i < 128; i++)
+        Get(memo, "long" + std::to_string(i), computed, hit);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Get(memo, "next", computed, hit);
+    Get(memo, "long0", computed, hit);
+    CHECK(hit);
+    CHECK(computed == 257);
+
+    // 仍然满时移除全部已完成的结果
+    for(int i = 0; i < 127; i++)
+        Get(memo, "more" + std::to_string(i), computed, hit);
+    Get(memo, "long1", computed, hit);
+    CHECK(hit);
+    Get(memo, "overflow", computed, hit);
+    Get(memo, "long1", computed, hit);
+    CHECK(!hit);
+}
@@ -0,0 +1,70 @@
+#include "check.hpp"
+#include "metrics.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+TEST_CASE(HistogramBuckets)
+{
+    // 小值逐个计数，之后每个2的幂区间均分为16份，桶号单调不减
+    for(uint64_t value = 0; value < 16; value++)
+        CHECK(Histogram::BucketOf(value) == value);
+    CHECK(Histogram::BucketOf(16) == 16);
+    CHECK(Histogram::BucketOf(31) == 31);
+    CHECK(Histogram::BucketOf(32) == 32);
+    CHECK(Histogram::BucketOf(33) == 32);
+    CHECK(Histogram::BucketOf(~uint64_t(0)) == Histogram::BUCKETS - 1);
+
+    size_t last = 0;
+    for(uint64_t value = 1; value < (uint64_t(1) << 41); value = value * 3 / 2 + 1)
+    {
+        size_t bucket = Histogram::BucketOf(value);
+        CHECK(bucket >= last && bucket < Histogram::BUCKETS);
+        last = bucket;
+        // 区间中点与原值的误差不超过区间宽度的一半，即约3%
+        uint64_t middle = Histogram::ValueOf(bucket);
+        uint64_t error  = middle > value ? middle - value : value - middle;
+        CHECK(error * 32 <= value + 32);
+    }
+}
+
+TEST_CASE(HistogramPercentiles)
+{
+    Histogram histogram;
+    CHECK(histogram.Percentile(50) == 0);
+    for(uint64_t value = 1; value <= 100; value++)
+        histogram.Record(value * 1000);
+    CHECK(histogram.GetCount() == 100);
+
+    auto p50 = histogram.Percentile(50);
+    auto p99 = histogram.Percentile(99);
+    CHECK(p50 >= 48000 && p50 <= 52000);
+    CHECK(p99 >= 96000 && p99 <= 102000);
+    CHECK(histogram.Percentile(0) <= histogram.Percentile(100));
+
+    auto summary = histogram.ToJson();
+    CHECK(summary["count"] == 100);
+    CHECK(summary["meanUs"] == 50.5);
+    CHECK(summary["maxUs"] == 100.0);
+}
+
+TEST_CASE(FunctionMetricsCountCalls)
+{
+    auto& bridge = Bridge::GetInstance();
+    bridge.Register("test.metrics.check",
+        [](Object args)
+        {
+            if(!args.value("ok", false))
+                throw BridgeError("invalid_argument", "Not ok");
+            return Object(true);
+        });
+
+    Test::Page page(0x8001);
+    page.Call(1, "test.metrics.check", { { "ok", true } });
+    page.Call(2, "test.metrics.check", { { "ok", false } });
+
+    auto metrics = bridge.GetMetrics()["test.metrics.check"];
+    CHECK(metrics["calls"] == 2);
+    CHECK(metrics["errors"] == 1);
+    CHECK(metrics["dispatch"]["count"] == 2);
+}
@@ -0,0 +1,140 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "assetpack.hpp"
+#include "assetstream.hpp"
+#include "check.hpp"
+#include "packwriter.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    BinaryData AsBinary(const std::string& text)
+    {
+        return BinaryData(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+}
+
+TEST_CASE(PackRecordsSeekable)
+{
+    std::string media(100000, 'm');
+    for(size_t i = 0; i < media.size(); i++)
+        media[i] = static_cast<char>('a' + i * 7 % 26);
+
+    // 直接存放的数据以seekable的跳转表结尾，仍不是分帧存放
+    auto        frames = AssetPackWriter::CompressSeekable(AsBinary(media), 3, 16 << 10);
+    std::string lookalike(frames.begin(), frames.end());
+
+    AssetPackWriter writer;
+    writer.AddSeekable("media", AsBinary(media), 3, 16 << 10);
+    writer.AddStored("lookalike", AsBinary(lookalike));
+    writer.Add("plain", AsBinary(media), 3);
+    writer.AddAlias("alias", "media");
+    CHECK(AssetStream::IsSeekable(frames));
+
+    bool threw = false;
+    try
+    {
+        writer.AddCompressedSeekable("invalid", AsBinary(media));
+    }
+    catch(const std::runtime_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    auto      data = writer.Finish();
+    AssetPack pack { BinaryData(data) };
+    CHECK(pack.Find("media") && pack.Find("media")->seekable);
+    CHECK(pack.Find("alias") && pack.Find("alias")->seekable);
+    CHECK(pack.Find("lookalike") && !pack.Find("lookalike")->seekable);
+    CHECK(pack.Find("plain") && !pack.Find("plain")->seekable);
+    CHECK(!pack.Contains("invalid"));
+
+    auto stream = pack.OpenStream("media");
+    CHECK(stream && stream->GetLength() == media.size());
+    CHECK(!pack.OpenStream("lookalike"));
+}
+
+namespace
+{
+    // 按json清单结束时是否抛出异常
+    template <typename Fill> bool JsonRejects(Fill fill)
+    {
+        AssetPackWriter writer;
+        fill(writer);
+        try
+        {
+            writer.Finish(IndexFormat::json, 3);
+        }
+        catch(const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+TEST_CASE(PackJsonManifestRejectsNewFeatures)
+{
+    std::string text(100000, 't');
+    for(size_t i = 0; i < text.size(); i++)
+        text[i] = static_cast<char>('a' + i * 13 % 26);
+
+    CHECK(JsonRejects(
+        [&](AssetPackWriter& writer)
+        {
+            writer.AddDictionary("dict", std::vector<uint8_t>(text.begin(), text.begin() + 1024));
+            writer.Add("a", AsBinary(text), 3, "dict");
+        }));
+    // 只是写入字典也不行，旧版本会把字典表当作资源
+    CHECK(JsonRejects([&](AssetPackWriter& writer)
+        { writer.AddDictionary("dict", std::vector<uint8_t>(text.begin(), text.begin() + 1024)); }));
+    CHECK(JsonRejects([&](AssetPackWriter& writer) { writer.AddSeekable("a", AsBinary(text), 3, 16 << 10); }));
+
+    // 单帧的分帧资源在旧版本中可以整体解压
+    AssetPackWriter writer;
+    writer.AddSeekable("single", AsBinary(text), 3, 1 << 20);
+    writer.Add("plain", AsBinary(text), 3);
+    auto      data = writer.Finish(IndexFormat::json, 3);
+    AssetPack pack { BinaryData(data) };
+    auto      single = pack.GetAssetData("single");
+    auto      plain  = pack.GetAssetData("plain");
+    CHECK(std::string(single.begin(), single.end()) == text);
+    CHECK(std::string(plain.begin(), plain.end()) == text);
+}
+
+TEST_CASE(PackStoredRoundTrip)
+{
+    std::string image(5000, 'i');
+    for(size_t i = 0; i < image.size(); i++)
+        image[i] = static_cast<char>(i * 31);
+
+    AssetPackWriter writer;
+    writer.AddStored("image", AsBinary(image));
+    writer.AddAlias("copy", "image");
+    writer.Add("compressed", AsBinary(image), 3);
+    writer.AddStored("empty", AsBinary(""));
+    auto      data = writer.Finish();
+    AssetPack pack { BinaryData(data) };
+
+    // 直接引用包内的数据，不复制
+    auto stored = pack.GetStored("image");
+    CHECK(stored.size() == image.size());
+    CHECK(std::string(stored.begin(), stored.end()) == image);
+    CHECK(stored.data() >= data.data() && stored.data() + stored.size() <= data.data() + data.size());
+    CHECK(pack.GetStored("copy").data() == stored.data());
+    CHECK(pack.Find("image") && pack.Find("image")->stored);
+
+    // 也可以按普通资源读取
+    auto copied = pack.GetAssetData("image");
+    CHECK(std::string(copied.begin(), copied.end()) == image);
+
+    CHECK(pack.Contains("empty") && pack.GetStored("empty").empty());
+    CHECK(pack.GetStored("compressed").empty());
+    CHECK(pack.GetStored("missing").empty());
+
+    CHECK(JsonRejects([&](AssetPackWriter& legacy) { legacy.AddStored("image", AsBinary(image)); }));
+}
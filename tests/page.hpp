@@ -0,0 +1,120 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "bridge.hpp"
+
+namespace ezi::Test
+{
+    // 通过回环通道挂到Bridge上的页面，收集发给页面的消息
+    // Bridge是单例，各用例使用不同的id，析构时断开
+    class Page
+    {
+    private:
+        WinId                              winId;
+        std::shared_ptr<LoopbackTransport> transport;
+        std::mutex                         mutex;
+        std::vector<Json>                  messages;
+
+    public:
+        explicit Page(uintptr_t id) : winId(reinterpret_cast<WinId>(id))
+        {
+            transport = std::make_shared<LoopbackTransport>(
+                [this](std::string_view payload, WireFormat format)
+                {
+                    std::lock_guard lock(mutex);
+                    messages.push_back(format == WireFormat::msgpack ? Json::from_msgpack(payload)
+                                                                     : Json::parse(payload));
+                });
+            Bridge::GetInstance().Attach(winId, transport);
+        }
+
+        ~Page()
+        {
+            Bridge::GetInstance().Detach(winId);
+        }
+
+    public:
+        WinId GetId() const
+        {
+            return winId;
+        }
+
+        LoopbackTransport& GetTransport()
+        {
+            return *transport;
+        }
+
+        void Send(const Json& message)
+        {
+            transport->Deliver(message.dump());
+        }
+
+        // 发给该id的全部消息，包括流的数据块
+        std::vector<Json> Take(const Json& id)
+        {
+            std::lock_guard   lock(mutex);
+            std::vector<Json> taken;
+            std::erase_if(messages,
+                [&](Json& message)
+                {
+                    if(!message.is_object() || message.value("id", Json()) != id)
+                        return false;
+                    taken.push_back(std::move(message));
+                    return true;
+                });
+            return taken;
+        }
+
+        // 在当前线程上泵取窗口任务，直到收到该id的最终回复或超时
+        std::optional<Json> WaitFor(const Json& id, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+        {
+            auto deadline = Clock::now() + timeout;
+            while(true)
+            {
+                transport->Pump();
+                {
+                    std::lock_guard lock(mutex);
+                    for(auto it = messages.begin(); it != messages.end(); it++)
+                    {
+                        if(it->is_object() && it->value("id", Json()) == id && !it->contains("chunk"))
+                        {
+                            Json message = std::move(*it);
+                            messages.erase(it);
+                            return message;
+                        }
+                    }
+                }
+                if(Clock::now() >= deadline)
+                    return std::nullopt;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // 在当前线程上泵取窗口任务一段时间
+        void PumpFor(std::chrono::milliseconds duration)
+        {
+            auto deadline = Clock::now() + duration;
+            while(Clock::now() < deadline)
+            {
+                transport->Pump();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // 发送调用并等待结果
+        std::optional<Json> Call(const Json& id, const String& func, const Json& args = Json::object())
+        {
+            Send({ { "id", id }, { "func", func }, { "args", args } });
+            auto reply = WaitFor(id);
+            if(!reply)
+                return std::nullopt;
+            return reply->value("result", Json());
+        }
+    };
+}
@@ -0,0 +1,39 @@
+#include "assetstream.hpp"
+#include "check.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    bool IsRange(std::string_view header, uint64_t length, uint64_t begin, uint64_t end)
+    {
+        ByteRange range;
+        return ParseByteRange(header, length, range) == RangeResult::partial && range.begin == begin
+               && range.end == end;
+    }
+}
+
+TEST_CASE(ParseByteRangeAccepts)
+{
+    CHECK(IsRange("bytes=0-99", 1000, 0, 100));
+    CHECK(IsRange("bytes=100-", 1000, 100, 1000));
+    CHECK(IsRange("bytes=-100", 1000, 900, 1000));
+    CHECK(IsRange("bytes=-5000", 1000, 0, 1000));
+    // 结束位置超出长度时截到末尾
+    CHECK(IsRange("bytes=900-5000", 1000, 900, 1000));
+}
+
+TEST_CASE(ParseByteRangeRejects)
+{
+    // 无法解析的头按没有范围处理，返回完整内容
+    ByteRange range;
+    CHECK(ParseByteRange("", 1000, range) == RangeResult::none);
+    CHECK(ParseByteRange("items=0-1", 1000, range) == RangeResult::none);
+    CHECK(ParseByteRange("bytes=0-1,5-6", 1000, range) == RangeResult::none);
+    CHECK(ParseByteRange("bytes=5-1", 1000, range) == RangeResult::none);
+    CHECK(ParseByteRange("bytes=a-1", 1000, range) == RangeResult::none);
+
+    CHECK(ParseByteRange("bytes=1000-", 1000, range) == RangeResult::unsatisfiable);
+    CHECK(ParseByteRange("bytes=-0", 1000, range) == RangeResult::unsatisfiable);
+    CHECK(ParseByteRange("bytes=-10", 0, range) == RangeResult::unsatisfiable);
+}
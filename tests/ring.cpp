@@ -0,0 +1,134 @@
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "page.hpp"
+#include "ring.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    std::vector<uint8_t> Bytes(size_t size, uint8_t first)
+    {
+        std::vector<uint8_t> bytes(size);
+        for(size_t i = 0; i < size; i++)
+            bytes[i] = static_cast<uint8_t>(first + i);
+        return bytes;
+    }
+}
+
+TEST_CASE(RingWrapsToContiguousSlice)
+{
+    std::vector<uint8_t> memory(70);
+    SharedRing           ring(memory.data(), memory.size());
+    // 容量按对齐向下取整
+    CHECK(ring.GetCapacity() == 64);
+
+    auto first  = ring.Write(Bytes(24, 0));
+    auto second = ring.Write(Bytes(21, 100));
+    CHECK(first && first->seq == 0 && first->offset == 0 && first->length == 24);
+    CHECK(second && second->seq == 1 && second->offset == 24 && second->length == 21);
+    CHECK(ring.GetUsed() == 48);
+
+    // 尾部只剩16字节，放不下的数据跳到开头，跳过的部分计入占用
+    CHECK(ring.Release(0));
+    auto third = ring.Write(Bytes(24, 200));
+    CHECK(third && third->seq == 2 && third->offset == 0);
+    CHECK(ring.GetUsed() == 64);
+    if(third)
+        CHECK(!std::memcmp(memory.data() + third->offset, Bytes(24, 200).data(), 24));
+    if(second)
+        CHECK(!std::memcmp(memory.data() + second->offset, Bytes(21, 100).data(), 21));
+}
+
+TEST_CASE(RingReleasesInSeqOrder)
+{
+    std::vector<uint8_t> memory(64);
+    SharedRing           ring(memory.data(), memory.size());
+    for(int i = 0; i < 4; i++)
+        CHECK(ring.Write(Bytes(16, 0)));
+    CHECK(ring.GetUsed() == 64);
+
+    for(uint64_t seq = 0; seq < 4; seq++)
+    {
+        CHECK(ring.Release(seq));
+        CHECK(ring.GetUsed() == 64 - (seq + 1) * 16);
+    }
+    // 已回收或未写入的序号
+    CHECK(!ring.Release(0));
+    CHECK(!ring.Release(4));
+}
+
+TEST_CASE(RingReleasesOutOfOrder)
+{
+    std::vector<uint8_t> memory(64);
+    SharedRing           ring(memory.data(), memory.size());
+    for(int i = 0; i < 3; i++)
+        CHECK(ring.Write(Bytes(16, 0)));
+
+    // 之前的段未释放时不回收空间
+    CHECK(ring.Release(2));
+    CHECK(ring.Release(1));
+    CHECK(ring.GetUsed() == 48);
+    CHECK(!ring.Write(Bytes(32, 0)));
+
+    // 最早的段释放后连同之后已释放的段一起回收
+    CHECK(ring.Release(0));
+    CHECK(ring.GetUsed() == 0);
+    auto slice = ring.Write(Bytes(32, 0));
+    CHECK(slice && slice->seq == 3);
+}
+
+TEST_CASE(RingFullFallsBack)
+{
+    std::vector<uint8_t> memory(64);
+    SharedRing           ring(memory.data(), memory.size());
+    CHECK(!ring.Write({}));
+    CHECK(!ring.Write(Bytes(65, 0)));
+
+    CHECK(ring.Write(Bytes(32, 0)));
+    CHECK(ring.Write(Bytes(32, 0)));
+    CHECK(!ring.Write(Bytes(1, 0)));
+
+    // 页面重新加载后之前的段全部作废
+    ring.Reset();
+    CHECK(ring.GetUsed() == 0);
+    CHECK(!ring.Release(0));
+    auto slice = ring.Write(Bytes(8, 0));
+    CHECK(slice && slice->seq == 2);
+}
+
+TEST_CASE(RingCarriesBridgeResults)
+{
+    auto& bridge = Bridge::GetInstance();
+    bridge.Register("test.ring.read", [](Object args) { return Object(Json::binary(Bytes(args["size"], 1))); });
+    bridge.SetRing(64, 16);
+
+    Test::Page page(0xC001);
+    auto       opened = page.Call("open", "bridge.openRing");
+    CHECK(opened && (*opened)["capacity"] == 64 && (*opened)["threshold"] == 16);
+
+    // 达到阈值的二进制值只在消息中留下位置
+    auto result = page.Call(1, "test.ring.read", { { "size", 40 } });
+    CHECK(result && result->value("$ring", -1) == 0 && (*result)["length"] == 40);
+    if(result && result->contains("offset"))
+    {
+        auto memory = page.GetTransport().GetRingMemory() + (*result)["offset"].get<size_t>();
+        CHECK(!std::memcmp(memory, Bytes(40, 1).data(), 40));
+    }
+
+    // 小于阈值的值和缓冲区放不下的值按原样内联发送
+    result = page.Call(2, "test.ring.read", { { "size", 8 } });
+    CHECK(result && result->contains("bytes") && (*result)["bytes"].size() == 8);
+    result = page.Call(3, "test.ring.read", { { "size", 40 } });
+    CHECK(result && result->contains("bytes") && (*result)["bytes"].size() == 40);
+
+    // 释放后空间重新可用
+    auto released = page.Call("release", "bridge.release", { { "seqs", { 0 } } });
+    CHECK(released && *released == true);
+    result = page.Call(4, "test.ring.read", { { "size", 40 } });
+    CHECK(result && result->value("$ring", -1) == 1);
+
+    bridge.SetRing(8 << 20, 16 << 10);
+}
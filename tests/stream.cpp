@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <atomic>
+
+#include "check.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    // 写出count个数据块，额度被关闭时提前结束
+    struct Counter
+    {
+        std::atomic<int>  written  = 0;
+        std::atomic<bool> finished = false;
+        std::atomic<bool> stopped  = false;
+
+        void Run(Object args, ResponseStream& stream)
+        {
+            for(int i = 0; i < args["count"].get<int>(); i++)
+            {
+                if(!stream.Write(i))
+                {
+                    stopped = true;
+                    break;
+                }
+                written++;
+            }
+            finished = true;
+        }
+    };
+
+    size_t CountChunks(const std::vector<Json>& messages)
+    {
+        return std::count_if(messages.begin(), messages.end(), [](auto& message) { return message.contains("chunk"); });
+    }
+
+    bool WaitUntil(const std::atomic<bool>& flag, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+    {
+        auto deadline = Clock::now() + timeout;
+        while(!flag && Clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return flag;
+    }
+}
+
+TEST_CASE(StreamBlocksUntilAck)
+{
+    auto&   bridge = Bridge::GetInstance();
+    Counter counter;
+    bridge.RegisterStream("test.stream.credit",
+        [&counter](Object args, ResponseStream& stream) { counter.Run(std::move(args), stream); });
+    bridge.SetStreamWindow(2);
+
+    Test::Page page(0x6001);
+    page.Send({ { "id", 1 }, { "func", "test.stream.credit" }, { "args", { { "count", 5 } } } });
+
+    // 额度用完后Write阻塞，页面只收到窗口大小的块
+    page.PumpFor(std::chrono::milliseconds(100));
+    auto messages = page.Take(1);
+    CHECK(counter.written == 2);
+    CHECK(CountChunks(messages) == 2);
+    CHECK(!counter.finished);
+
+    // 归还额度后继续写出
+    auto acked = page.Call("ack1", "bridge.ack", { { "id", 1 }, { "count", 2 } });
+    CHECK(acked && *acked == true);
+    page.PumpFor(std::chrono::milliseconds(100));
+    messages = page.Take(1);
+    CHECK(counter.written == 4);
+    CHECK(CountChunks(messages) == 2);
+    if(messages.size() == 2)
+        CHECK(messages[0]["seq"] == 2 && messages[1]["seq"] == 3);
+
+    page.Call("ack2", "bridge.ack", { { "id", 1 }, { "count", 2 } });
+    auto done = page.WaitFor(1);
+    CHECK(counter.written == 5);
+    CHECK(done && done->value("done", false) && (*done)["seq"] == 5);
+    CHECK(done && (*done)["result"].is_null());
+
+    // 已结束的流不再接受额度
+    acked = page.Call("ack3", "bridge.ack", { { "id", 1 }, { "count", 1 } });
+    CHECK(acked && *acked == false);
+    bridge.SetStreamWindow(8);
+}
+
+TEST_CASE(StreamTimesOutWithoutAck)
+{
+    auto&   bridge = Bridge::GetInstance();
+    Counter counter;
+    bridge.RegisterStream("test.stream.timeout",
+        [&counter](Object args, ResponseStream& stream) { counter.Run(std::move(args), stream); });
+    bridge.SetStreamWindow(1);
+    bridge.SetStreamTimeout(std::chrono::milliseconds(50));
+
+    Test::Page page(0x6002);
+    page.Send({ { "id", 1 }, { "func", "test.stream.timeout" }, { "args", { { "count", 3 } } } });
+    auto done = page.WaitFor(1);
+    CHECK(counter.stopped);
+    CHECK(counter.written == 1);
+    CHECK(done && done->value("done", false) && (*done)["seq"] == 1);
+    CHECK(done && (*done)["result"].value("code", "") == "timeout");
+
+    bridge.SetStreamTimeout(std::chrono::seconds(30));
+    bridge.SetStreamWindow(8);
+}
+
+TEST_CASE(StreamClosedOnCancelWindow)
+{
+    auto&   bridge = Bridge::GetInstance();
+    Counter counter;
+    bridge.RegisterStream("test.stream.cancel",
+        [&counter](Object args, ResponseStream& stream) { counter.Run(std::move(args), stream); });
+    bridge.SetStreamWindow(1);
+
+    Test::Page page(0x6003);
+    page.Send({ { "id", 1 }, { "func", "test.stream.cancel" }, { "args", { { "count", 3 } } } });
+    page.PumpFor(std::chrono::milliseconds(50));
+    CHECK(counter.written == 1);
+    CHECK(!counter.finished);
+
+    // 页面跳转时阻塞中的Write立即返回false，流以cancelled结束
+    bridge.CancelWindow(page.GetId());
+    CHECK(WaitUntil(counter.finished));
+    CHECK(counter.stopped);
+    auto done = page.WaitFor(1);
+    CHECK(done && (*done)["result"].value("code", "") == "cancelled");
+
+    // 流已从表中移除
+    auto acked = page.Call("ack", "bridge.ack", { { "id", 1 }, { "count", 1 } });
+    CHECK(acked && *acked == false);
+    bridge.SetStreamWindow(8);
+}
+
+TEST_CASE(StreamClosedOnDetach)
+{
+    auto&   bridge = Bridge::GetInstance();
+    Counter counter;
+    bridge.RegisterStream("test.stream.detach",
+        [&counter](Object args, ResponseStream& stream) { counter.Run(std::move(args), stream); });
+    bridge.SetStreamWindow(1);
+
+    {
+        Test::Page page(0x6004);
+        page.Send({ { "id", 1 }, { "func", "test.stream.detach" }, { "args", { { "count", 3 } } } });
+        page.PumpFor(std::chrono::milliseconds(50));
+        CHECK(counter.written == 1);
+    }
+    // 窗口关闭后不等超时，处理函数随即结束
+    CHECK(WaitUntil(counter.finished, std::chrono::seconds(1)));
+    CHECK(counter.stopped);
+    bridge.SetStreamWindow(8);
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+#include "page.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    // 单线程的线程池先被一个任务占住，之后提交的任务按取出的顺序记录
+    struct JobLog
+    {
+        std::mutex        mutex;
+        std::vector<char> order;
+        std::atomic<bool> blocked = false;
+        std::atomic<bool> open    = false;
+
+        // 提交后等到线程确实被占住才返回，之后提交的任务都在队列中等待
+        void Block(WorkerPool& pool)
+        {
+            pool.Submit(
+                [this]
+                {
+                    blocked = true;
+                    while(!open)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                });
+            while(!blocked)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        Job Mark(char name)
+        {
+            return [this, name]
+            {
+                std::lock_guard lock(mutex);
+                order.push_back(name);
+            };
+        }
+    };
+}
+
+TEST_CASE(WorkerPoolRunsByPriority)
+{
+    JobLog log;
+    {
+        WorkerPool pool(1, std::chrono::seconds(10));
+        log.Block(pool);
+        pool.Submit(log.Mark('b'), Priority::bulk);
+        pool.Submit(log.Mark('n'), Priority::normal);
+        pool.Submit(log.Mark('i'), Priority::interactive);
+        log.open = true;
+    }
+    CHECK((log.order == std::vector<char> { 'i', 'n', 'b' }));
+}
+
+TEST_CASE(WorkerPoolAgesLowPriority)
+{
+    // 持续有交互任务时，等待超过aging的批量任务先执行
+    JobLog log;
+    {
+        WorkerPool pool(1, std::chrono::milliseconds(20));
+        log.Block(pool);
+        pool.Submit(log.Mark('b'), Priority::bulk);
+        for(int i = 0; i < 20; i++)
+            pool.Submit(log.Mark('i'), Priority::interactive);
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        log.open = true;
+    }
+    CHECK(log.order.size() == 21);
+    CHECK(!log.order.empty() && log.order.front() == 'b');
+
+    // 未到时限时仍按优先级
+    JobLog fresh;
+    {
+        WorkerPool pool(1, std::chrono::seconds(10));
+        fresh.Block(pool);
+        pool.Submit(fresh.Mark('b'), Priority::bulk);
+        for(int i = 0; i < 20; i++)
+            pool.Submit(fresh.Mark('i'), Priority::interactive);
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        fresh.open = true;
+    }
+    CHECK(!fresh.order.empty() && fresh.order.back() == 'b');
+}
+
+TEST_CASE(QueueLimitRejectsPerWindow)
+{
+    auto&             bridge = Bridge::GetInstance();
+    std::atomic<bool> open   = false;
+    bridge.RegisterAsync("test.queue.block",
+        [&open](Object) -> Task
+        {
+            while(!open)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            co_return true;
+        });
+    bridge.SetQueueLimit(2);
+
+    Test::Page page(0x7001);
+    Test::Page other(0x7002);
+    String     key            = std::to_string(reinterpret_cast<uintptr_t>(page.GetId()));
+    auto       rejectedBefore = bridge.GetQueueStats()["priorities"]["normal"]["rejected"].get<uint64_t>();
+    int        sent           = 0;
+    Json       rejected;
+
+    // 工作线程全部被占住后，排队的请求达到上限时拒绝
+    for(; sent < 512 && rejected.is_null(); sent++)
+    {
+        page.Send({ { "id", sent }, { "func", "test.queue.block" } });
+        if(auto reply = page.WaitFor(sent, std::chrono::milliseconds(2)))
+            rejected = (*reply)["result"];
+    }
+    CHECK(rejected.value("code", "") == "backpressure");
+
+    auto stats = bridge.GetQueueStats();
+    CHECK(stats["limit"] == 2);
+    CHECK(stats["windows"].value(key, 0) == 2);
+    CHECK(stats["priorities"]["normal"]["rejected"].get<uint64_t>() == rejectedBefore + 1);
+
+    // 上限按窗口计算，其他窗口不受影响
+    other.Send({ { "id", "other" }, { "func", "test.queue.block" } });
+
+    open = true;
+    for(int id = 0; id < sent - 1; id++)
+    {
+        auto reply = page.WaitFor(id);
+        CHECK(reply && (*reply)["result"] == true);
+    }
+    auto reply = other.WaitFor("other");
+    CHECK(reply && (*reply)["result"] == true);
+
+    // 没有排队请求的窗口不再留在统计中
+    stats = bridge.GetQueueStats();
+    CHECK(!stats["windows"].contains(key));
+    CHECK(!stats["windows"].contains(std::to_string(reinterpret_cast<uintptr_t>(other.GetId()))));
+    bridge.SetQueueLimit(64);
+}
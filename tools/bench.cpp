@@ -0,0 +1,440 @@
+// ezi_bench：核心热点路径的基准测试，输出稳定的json供升级前后对比
+// 用法：ezi_bench [--filter <子串>] [--min-time <毫秒>] [--baseline <文件>] [--tolerance <比例>]
+//   --baseline  与之前的输出对比，任一项的p50慢于基线超过tolerance（默认0.1）时返回1
+// 每项按批计时，单批不短于20微秒，以批内平均值作为一个样本记入直方图
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include <zstd.h>
+
+#include "assetcache.hpp"
+#include "assetpack.hpp"
+#include "assetstream.hpp"
+#include "packwriter.hpp"
+#include "bridge.hpp"
+#include "ezienv.hpp"
+#include "json.hpp"
+#include "platform.hpp"
+
+using namespace ezi;
+
+// 外部链接，避免被测的结果被优化掉
+size_t sink = 0;
+
+namespace
+{
+    struct Options
+    {
+        String filter;
+        int    minTimeMs = 500;
+        String baseline;
+        double tolerance = 0.1;
+    };
+
+    struct Benchmark
+    {
+        String                name;
+        std::function<void()> run;
+        size_t                bytes = 0;
+    };
+
+    struct Result
+    {
+        String   name;
+        uint64_t iterations = 0;
+        double   meanNs     = 0;
+        uint64_t p50Ns      = 0;
+        uint64_t p90Ns      = 0;
+        uint64_t p99Ns      = 0;
+        size_t   bytes      = 0;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            if(!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+                options.filter = argv[++i];
+            else if(!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+                options.minTimeMs = std::atoi(argv[++i]);
+            else if(!std::strcmp(argv[i], "--baseline") && i + 1 < argc)
+                options.baseline = argv[++i];
+            else if(!std::strcmp(argv[i], "--tolerance") && i + 1 < argc)
+                options.tolerance = std::atof(argv[++i]);
+            else
+                return false;
+        }
+        return options.minTimeMs > 0 && options.tolerance >= 0;
+    }
+
+    // 固定种子的伪文本，压缩率接近真实的前端资源
+    std::string MakeText(size_t size, uint32_t seed)
+    {
+        static const char* words[] = { "function", "return", "const", "let", "this", "window", "document", "=>",
+            "{", "}", "(", ")", ";", "import", "export", "default", "class", "async", "await", "0x1f", "div", "span" };
+
+        std::string text;
+        text.reserve(size + 16);
+        while(text.size() < size)
+        {
+            seed = seed * 1664525 + 1013904223;
+            text += words[(seed >> 16) % std::size(words)];
+            text += (seed & 0x7) == 0 ? '\n' : ' ';
+        }
+        text.resize(size);
+        return text;
+    }
+
+    BinaryData AsBinary(const std::string& text)
+    {
+        return BinaryData(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+
+    // dictionary不为空时先用全部资源训练字典，再用字典压缩各资源
+    std::vector<uint8_t> MakePack(const std::vector<std::pair<String, std::string>>& assets,
+        bool                                                                    dictionary = false,
+        IndexFormat                                                             format     = IndexFormat::binary)
+    {
+        AssetPackWriter writer;
+        String          name;
+        if(dictionary)
+        {
+            std::vector<BinaryData> samples;
+            for(auto& [uri, data] : assets)
+            {
+                samples.push_back(AsBinary(data));
+            }
+            name = "bench";
+            writer.AddDictionary(name, AssetPackWriter::TrainDictionary(samples, 16 << 10));
+        }
+        for(auto& [uri, data] : assets)
+        {
+            writer.Add(uri, AsBinary(data), ZSTD_CLEVEL_DEFAULT, name);
+        }
+        return writer.Finish(format, ZSTD_CLEVEL_DEFAULT);
+    }
+
+    Result Measure(const Benchmark& benchmark, std::chrono::milliseconds minTime)
+    {
+        // 找到使单批不短于20微秒的批大小，同时作为预热
+        uint64_t batch = 1;
+        while(true)
+        {
+            auto started = Clock::now();
+            for(uint64_t i = 0; i < batch; i++)
+            {
+                benchmark.run();
+            }
+            if(ElapsedNs(started) >= 20000 || batch >= (1 << 20))
+                break;
+            batch *= 2;
+        }
+
+        Histogram histogram;
+        Result    result;
+        uint64_t  totalNs = 0;
+        auto      started = Clock::now();
+        while(Clock::now() - started < minTime)
+        {
+            auto batchStarted = Clock::now();
+            for(uint64_t i = 0; i < batch; i++)
+            {
+                benchmark.run();
+            }
+            uint64_t elapsed = ElapsedNs(batchStarted);
+            histogram.Record(elapsed / batch);
+            totalNs += elapsed;
+            result.iterations += batch;
+        }
+
+        result.name   = benchmark.name;
+        result.meanNs = static_cast<double>(totalNs) / result.iterations;
+        result.p50Ns  = histogram.Percentile(50);
+        result.p90Ns  = histogram.Percentile(90);
+        result.p99Ns  = histogram.Percentile(99);
+        result.bytes  = benchmark.bytes;
+        return result;
+    }
+
+    Json ToJson(const Result& result)
+    {
+        Json item = {
+            { "name", result.name },
+            { "iterations", result.iterations },
+            { "meanNs", std::round(result.meanNs * 10) / 10 },
+            { "p50Ns", result.p50Ns },
+            { "p90Ns", result.p90Ns },
+            { "p99Ns", result.p99Ns },
+        };
+        if(result.bytes)
+            item["mbPerSec"] = std::round(result.bytes / result.meanNs * 1e9 / (1 << 20) * 10) / 10;
+        return item;
+    }
+
+    // 返回变慢超过容差的项数
+    int Compare(const Json& current, const Json& baseline, double tolerance)
+    {
+        std::unordered_map<String, uint64_t> previous;
+        for(auto& item : baseline.value("benchmarks", Json::array()))
+        {
+            previous[item.at("name").get<String>()] = item.at("p50Ns").get<uint64_t>();
+        }
+
+        int regressions = 0;
+        for(auto& item : current["benchmarks"])
+        {
+            auto it = previous.find(item["name"].get<String>());
+            if(it == previous.end() || it->second == 0)
+                continue;
+            double ratio = item["p50Ns"].get<double>() / it->second;
+            if(ratio > 1 + tolerance)
+            {
+                std::cerr << "regression: " << it->first << " p50 " << it->second << "ns -> " << item["p50Ns"]
+                          << "ns (+" << static_cast<int>((ratio - 1) * 100) << "%)" << std::endl;
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+}
+
+static int Add(int a, int b)
+{
+    return a + b;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: ezi_bench [--filter <text>] [--min-time <ms>] [--baseline <file>] [--tolerance <ratio>]"
+                  << std::endl;
+        return 2;
+    }
+
+    std::vector<Benchmark> benchmarks;
+
+    // 桥接调用
+    auto& bridge = Bridge::GetInstance();
+    bridge.Register("bench.add", [](Object args) { return Json(args["a"].get<int>() + args["b"].get<int>()); });
+    bridge.Register("bench.typed", Add, "a", "b");
+    bridge.Register("bench.memo", [](Object args) { return Json(args["a"].get<int>() + args["b"].get<int>()); });
+    bridge.SetIdempotent("bench.memo", std::chrono::hours(1));
+    Json args = { { "a", 1 }, { "b", 2 } };
+    benchmarks.push_back({ "bridge.call", [&] { sink += bridge.Call("bench.add", args).get<int>(); } });
+    benchmarks.push_back({ "bridge.call.typed", [&] { sink += bridge.Call("bench.typed", args).get<int>(); } });
+
+    // 经回环通道的完整派发：解析、查表、调用、序列化
+    std::string reply;
+    auto        transport = std::make_shared<LoopbackTransport>([&reply](std::string_view payload, WireFormat)
+        { reply.assign(payload); });
+    WinId       winId     = reinterpret_cast<WinId>(1);
+    bridge.Attach(winId, transport);
+    benchmarks.push_back({ "bridge.dispatch.json",
+        [&]
+        {
+            transport->Deliver(R"({"id":1,"func":"bench.add","args":{"a":1,"b":2}})");
+            bridge.Pump(winId);
+            sink += reply.size();
+        } });
+    benchmarks.push_back({ "bridge.dispatch.memo",
+        [&]
+        {
+            transport->Deliver(R"({"id":1,"func":"bench.memo","args":{"a":1,"b":2}})");
+            bridge.Pump(winId);
+            sink += reply.size();
+        } });
+
+    // 资源解压
+    std::string smallAsset = MakeText(4 << 10, 1);
+    std::string largeAsset = MakeText(1 << 20, 2);
+    auto        packData   = MakePack({ { "small.js", smallAsset }, { "large.js", largeAsset } });
+    AssetPack   pack(packData);
+    benchmarks.push_back(
+        { "assets.get.4k", [&] { sink += pack.GetAssetData("small.js").size(); }, smallAsset.size() });
+    benchmarks.push_back(
+        { "assets.get.1m", [&] { sink += pack.GetAssetData("large.js").size(); }, largeAsset.size() });
+
+    // 大量小文件：复用解压上下文与每次新建上下文（原先的做法）对比
+    std::vector<std::pair<String, std::string>> smallFiles;
+    for(uint32_t i = 0; i < 256; i++)
+    {
+        smallFiles.emplace_back("chunk" + std::to_string(i) + ".js", MakeText(1024 + (i * 37) % 5120, i + 16));
+    }
+    auto      smallPackData = MakePack(smallFiles);
+    AssetPack smallPack(smallPackData);
+    size_t    next = 0;
+    benchmarks.push_back({ "assets.get.many",
+        [&]
+        {
+            sink += smallPack.GetAssetData(smallFiles[next].first).size();
+            next = (next + 1) % smallFiles.size();
+        } });
+    benchmarks.push_back({ "assets.get.many.oneshot",
+        [&]
+        {
+            auto                 meta = smallPack.Find(smallFiles[next].first);
+            const uint8_t*       data = smallPackData.data() + meta->offset;
+            auto                 size = ZSTD_getFrameContentSize(data, meta->size);
+            if(size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR)
+                throw std::runtime_error("Invalid asset frame: " + smallFiles[next].first);
+            std::vector<uint8_t> out(size);
+            size_t               result = ZSTD_decompress(out.data(), out.size(), data, meta->size);
+            if(ZSTD_isError(result))
+                throw std::runtime_error(ZSTD_getErrorName(result));
+            sink += result;
+            next = (next + 1) % smallFiles.size();
+        } });
+    auto      dictPackData = MakePack(smallFiles, true);
+    AssetPack dictPack(dictPackData);
+    benchmarks.push_back({ "assets.get.many.dict",
+        [&]
+        {
+            sink += dictPack.GetAssetData(smallFiles[next].first).size();
+            next = (next + 1) % smallFiles.size();
+        } });
+
+    // 索引加载与查找：二进制索引与旧的json清单对比
+    std::vector<std::pair<String, std::string>> manyFiles;
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+        manyFiles.emplace_back("assets/module" + std::to_string(i) + "/index.js", std::string(16, 'a' + i % 26));
+    }
+    auto indexPackData = MakePack(manyFiles);
+    auto jsonPackData  = MakePack(manyFiles, false, IndexFormat::json);
+    benchmarks.push_back({ "assets.open.index", [&] { sink += AssetPack(indexPackData).Contains("index.html"); } });
+    benchmarks.push_back({ "assets.open.json", [&] { sink += AssetPack(jsonPackData).Contains("index.html"); } });
+    AssetPack indexPack(indexPackData);
+    AssetPack jsonPack(jsonPackData);
+    size_t    nextFile = 0;
+    benchmarks.push_back({ "assets.find.index",
+        [&]
+        {
+            sink += indexPack.Find(manyFiles[nextFile].first)->size;
+            nextFile = (nextFile + 7919) % manyFiles.size();
+        } });
+    benchmarks.push_back({ "assets.find.json",
+        [&]
+        {
+            sink += jsonPack.Find(manyFiles[nextFile].first)->size;
+            nextFile = (nextFile + 7919) % manyFiles.size();
+        } });
+
+    // 分帧存放的大资源：随机读取64KiB，只解压涉及的帧
+    std::string     media = MakeText(8 << 20, 5);
+    AssetPackWriter mediaWriter;
+    mediaWriter.AddSeekable("media.mp4", AsBinary(media), ZSTD_CLEVEL_DEFAULT);
+    auto                 mediaPackData = mediaWriter.Finish();
+    AssetPack            mediaPack(mediaPackData);
+    auto                 mediaStream = mediaPack.OpenStream("media.mp4");
+    std::vector<uint8_t> chunk(64 << 10);
+    uint32_t             seed = 7;
+    benchmarks.push_back({ "assets.range.64k",
+        [&]
+        {
+            seed = seed * 1664525 + 1013904223;
+            sink += mediaStream->ReadAt(seed % (media.size() - chunk.size()), chunk.data(), chunk.size());
+        },
+        chunk.size() });
+
+    // 已压缩的格式：直接存放时引用包内的数据，与级别1压缩后每次解压对比
+    std::string     image = MakeText(256 << 10, 9);
+    AssetPackWriter imageWriter;
+    imageWriter.AddStored("image.png", AsBinary(image));
+    imageWriter.Add("image.zst.png", AsBinary(image), 1);
+    auto                 imagePackData = imageWriter.Finish();
+    AssetPack            imagePack(imagePackData);
+    std::vector<uint8_t> imageOut(image.size());
+    benchmarks.push_back({ "assets.get.stored",
+        [&]
+        {
+            // 与WebView读取时一样，从包内直接复制到调用方的缓冲区
+            BinaryData data = imagePack.GetStored("image.png");
+            std::memcpy(imageOut.data(), data.data(), data.size());
+            sink += data.size();
+        },
+        image.size() });
+    benchmarks.push_back(
+        { "assets.get.zstd1", [&] { sink += imagePack.GetAssetData("image.zst.png").size(); }, image.size() });
+
+    AssetCache cache;
+    benchmarks.push_back({ "assets.get.cached",
+        [&]
+        {
+            auto buffer = cache.Get("large.js");
+            if(!buffer)
+            {
+                buffer = std::make_shared<const std::vector<uint8_t>>(pack.GetAssetData("large.js"));
+                cache.Put("large.js", buffer);
+            }
+            sink += buffer->size();
+        } });
+
+    // 配置查找
+    Json config = {
+        { "application", { { "name", "EziApp" }, { "package", "com.ezi.app" } } },
+        { "bridge", { { "workers", 4 }, { "priorities", { { "fs.sync", "bulk" } } } } },
+        { "a", { { "b", { { "c", { { "d", { { "e", 42 } } } } } } } } },
+    };
+    benchmarks.push_back({ "config.at", [&] { sink += at<int>(config, "bridge.workers", 0); } });
+    benchmarks.push_back({ "config.at.deep", [&] { sink += at<int>(config, "a.b.c.d.e", 0); } });
+    benchmarks.push_back({ "config.at.missing", [&] { sink += at<int>(config, "bridge.missing.key", 0); } });
+
+    // env文件读写
+    Json env = {
+        { "ownerPath", "C:\\Program Files\\EziApp\\eziapp.exe" },
+        { "appName", "EziApp" },
+        { "package", "com.ezi.app" },
+        { "version", "1.0.0" },
+        { "windowPosition", { { "x", 120 }, { "y", 80 } } },
+    };
+    for(int i = 0; i < 32; i++)
+    {
+        env["permission:feature" + std::to_string(i)] = i % 2 == 0;
+    }
+    String envPath = (std::filesystem::temp_directory_path() / "ezi_bench.env").string();
+    EziEnv::SaveFile(envPath, env);
+    benchmarks.push_back({ "ezienv.save", [&] { EziEnv::SaveFile(envPath, env); } });
+    benchmarks.push_back({ "ezienv.load", [&] { sink += EziEnv::LoadFile(envPath).size(); } });
+
+    // 字符转换
+    std::string  utf8  = MakeText(2 << 10, 3) + "中文字符与表情😀混合的文本" + MakeText(2 << 10, 4);
+    std::wstring utf16 = utf8ToUtf16(utf8);
+    benchmarks.push_back({ "utf.utf8ToUtf16", [&] { sink += utf8ToUtf16(utf8).size(); }, utf8.size() });
+    benchmarks.push_back({ "utf.utf16ToUtf8", [&] { sink += utf16ToUtf8(utf16).size(); }, utf8.size() });
+
+    Json output = {
+        { "version", 1 },
+        { "benchmarks", Json::array() },
+        { "packBytes", { { "many", smallPackData.size() }, { "many.dict", dictPackData.size() } } },
+    };
+    for(auto& benchmark : benchmarks)
+    {
+        if(!options.filter.empty() && benchmark.name.find(options.filter) == String::npos)
+            continue;
+        output["benchmarks"].push_back(ToJson(Measure(benchmark, std::chrono::milliseconds(options.minTimeMs))));
+    }
+    std::filesystem::remove(envPath);
+    bridge.Detach(winId);
+
+    std::cout << output.dump(2) << std::endl;
+
+    if(!options.baseline.empty())
+    {
+        std::ifstream file(options.baseline);
+        if(!file)
+        {
+            std::cerr << "Cannot open baseline: " << options.baseline << std::endl;
+            return 2;
+        }
+        if(Compare(output, Json::parse(file), options.tolerance) > 0)
+            return 1;
+    }
+    return 0;
+}
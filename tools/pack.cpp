@@ -0,0 +1,693 @@
+// ezi-pack：把前端构建产物打成资源包
+// 用法：ezi-pack <目录> -o <输出文件> [--prefix <uri前缀>] [--config <配置文件>] [--jobs <线程数>]
+//                [--level <扩展名>=<级别>]... [--dict <扩展名>]... [--seekable <字节数>] [--json-manifest]
+//                [--cache <目录>] [--retrain] [--prune-cache]
+//   --prefix   资源uri的前缀，默认取配置中的 application.package，即 https://<package>/
+//   --config   压缩后以 ezi.config.manifest 写入包中；发布版的运行时从包中读取配置，缺少时只有调试版能使用该包
+//   --level    按扩展名设置压缩级别，如 --level js=22，store为不压缩直接存放
+//              默认文本类19，其余3；图片、字体、音视频等已压缩的格式直接存放，读取时不解压也不复制
+//   --dict     为该扩展名的小文件训练共享字典
+//   --seekable 不小于该大小且需要压缩的音视频和wasm分帧存放以支持按范围读取，默认4MiB，0为不分帧
+//   --json-manifest  写入旧的json清单，供旧版本的运行时读取；旧版本不支持直接存放、字典和分帧存放，
+//                    这时已压缩的格式改为级别1压缩，--dict 和 --seekable 不起作用
+//   --cache    压缩缓存目录，内容和压缩参数都未变化的文件直接复用上次的压缩结果
+//              训练出的字典也保存在其中并在之后复用，--retrain 时重新训练
+//   --prune-cache    删除缓存中本次没有用到的压缩结果
+// 内容相同的文件只压缩和存放一次；压缩在所有核上并行进行；输入目录中的输出文件和缓存目录不会被打包
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <latch>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <zstd.h>
+
+#include "assetindex.hpp"
+#include "assetstream.hpp"
+#include "metrics.hpp"
+#include "packwriter.hpp"
+#include "workers.hpp"
+
+using namespace ezi;
+namespace fs = std::filesystem;
+
+namespace
+{
+    static constexpr const char* CONFIGURI = "ezi.config.manifest";
+    // 只有小文件用字典压缩，大文件自身的内容已足够建立上下文
+    static constexpr size_t DICTIONARYMAXSIZE = 128 << 10;
+
+    struct Options
+    {
+        String                input;
+        String                output;
+        String                prefix;
+        String                config;
+        size_t                jobs = 0;
+        std::map<String, int> levels;
+        std::set<String>      stored;
+        std::set<String>      dictionaries;
+        size_t                seekableBytes = 4 << 20;
+        bool                  jsonManifest  = false;
+        String                cache;
+        bool                  retrain    = false;
+        bool                  pruneCache = false;
+    };
+
+    struct Asset
+    {
+        String               uri;
+        String               type;
+        fs::path             path;
+        std::vector<uint8_t> content;
+        uint64_t             hash = 0;
+        // 内容相同的第一个资源的序号，自身为第一个时为SIZE_MAX
+        size_t               source = SIZE_MAX;
+        int                  level  = 3;
+        String               dictionary;
+        bool                 seekable = false;
+        bool                 stored   = false;
+        std::vector<uint8_t> compressed;
+
+        size_t GetPackedSize() const
+        {
+            return stored ? content.size() : compressed.size();
+        }
+    };
+
+    struct TypeReport
+    {
+        size_t files      = 0;
+        size_t duplicates = 0;
+        size_t original   = 0;
+        size_t packed     = 0;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            if(!std::strcmp(argv[i], "-o") && i + 1 < argc)
+                options.output = argv[++i];
+            else if(!std::strcmp(argv[i], "--prefix") && i + 1 < argc)
+                options.prefix = argv[++i];
+            else if(!std::strcmp(argv[i], "--config") && i + 1 < argc)
+                options.config = argv[++i];
+            else if(!std::strcmp(argv[i], "--jobs") && i + 1 < argc)
+                options.jobs = std::atoi(argv[++i]);
+            else if(!std::strcmp(argv[i], "--level") && i + 1 < argc)
+            {
+                String value = argv[++i];
+                auto   equal = value.find('=');
+                if(equal == String::npos || equal == 0)
+                    return false;
+                String type = value.substr(0, equal);
+                options.levels.erase(type);
+                options.stored.erase(type);
+                if(value.substr(equal + 1) == "store")
+                    options.stored.insert(type);
+                else
+                    options.levels[type] = std::atoi(value.c_str() + equal + 1);
+            }
+            else if(!std::strcmp(argv[i], "--dict") && i + 1 < argc)
+                options.dictionaries.insert(argv[++i]);
+            else if(!std::strcmp(argv[i], "--seekable") && i + 1 < argc)
+                options.seekableBytes = std::strtoull(argv[++i], nullptr, 10);
+            else if(!std::strcmp(argv[i], "--json-manifest"))
+                options.jsonManifest = true;
+            else if(!std::strcmp(argv[i], "--cache") && i + 1 < argc)
+                options.cache = argv[++i];
+            else if(!std::strcmp(argv[i], "--retrain"))
+                options.retrain = true;
+            else if(!std::strcmp(argv[i], "--prune-cache"))
+                options.pruneCache = true;
+            else if(argv[i][0] != '-' && options.input.empty())
+                options.input = argv[i];
+            else
+                return false;
+        }
+        return !options.input.empty() && !options.output.empty() && (!options.pruneCache || !options.cache.empty());
+    }
+
+    String GetType(const fs::path& path)
+    {
+        String type = path.extension().string();
+        if(!type.empty())
+            type.erase(0, 1);
+        std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::tolower(c); });
+        return type;
+    }
+
+    bool IsCompressedType(const String& type)
+    {
+        static const std::set<String> types = { "png", "jpg", "jpeg", "gif", "webp", "avif", "mp4", "webm", "mp3",
+            "ogg", "woff", "woff2", "zip", "gz", "br" };
+        return types.contains(type);
+    }
+
+    int GetLevel(const Options& options, const String& type)
+    {
+        static const std::set<String> texts
+            = { "js", "mjs", "css", "html", "htm", "json", "svg", "txt", "map", "xml", "wasm", "manifest" };
+
+        if(auto it = options.levels.find(type); it != options.levels.end())
+            return it->second;
+        if(texts.contains(type))
+            return 19;
+        if(IsCompressedType(type))
+            return 1;
+        return 3;
+    }
+
+    bool IsStored(const Options& options, const String& type)
+    {
+        if(options.jsonManifest || options.levels.contains(type))
+            return false;
+        return options.stored.contains(type) || IsCompressedType(type);
+    }
+
+    bool IsSeekableType(const String& type)
+    {
+        static const std::set<String> types = { "mp4", "webm", "mp3", "ogg", "wasm" };
+        return types.contains(type);
+    }
+
+    std::vector<uint8_t> ReadFile(const fs::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("Failed to open " + path.string());
+        std::vector<uint8_t> content(fs::file_size(path));
+        file.read(reinterpret_cast<char*>(content.data()), content.size());
+        if(!file)
+            throw std::runtime_error("Failed to read " + path.string());
+        return content;
+    }
+
+    // 先写临时文件再改名，中断或并发的构建不会留下写了一半的文件
+    // 临时文件名含本次运行的随机数和序号，不会与其他进程或线程的临时文件重名
+    void WriteFile(const fs::path& path, BinaryData content)
+    {
+        static const uint64_t        run      = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+        static std::atomic<uint64_t> sequence = 0;
+
+        fs::path temp = path;
+        temp += ".tmp" + std::to_string(run) + "-" + std::to_string(sequence++);
+        {
+            std::ofstream file(temp, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(content.data()), content.size());
+            if(!file)
+            {
+                file.close();
+                std::error_code error;
+                fs::remove(temp, error);
+                throw std::runtime_error("Failed to write " + temp.string());
+            }
+        }
+        fs::rename(temp, path);
+    }
+
+    // 是否为path的临时文件
+    bool IsTempOf(const fs::path& file, const fs::path& path)
+    {
+        return file.parent_path() == path.parent_path()
+               && file.filename().string().starts_with(path.filename().string() + ".tmp");
+    }
+
+    std::string_view AsText(BinaryData data)
+    {
+        return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    // 压缩缓存，每个压缩结果存为一个文件，文件名由内容哈希和压缩参数算出
+    // 哈希只用于定位，命中后解压与原内容比较，一致才复用，不会因哈希碰撞写出错误的资源包
+    class CompressCache
+    {
+    private:
+        fs::path                        directory;
+        std::shared_ptr<DecompressPool> pool = std::make_shared<DecompressPool>();
+        std::mutex                      mutex;
+        std::set<String>                used;
+        std::atomic<size_t>             hits   = 0;
+        std::atomic<size_t>             misses = 0;
+
+    private:
+        bool Verify(const Asset& asset, BinaryData compressed, BinaryData dictionary)
+        {
+            std::vector<uint8_t> content(asset.content.size());
+            try
+            {
+                if(asset.seekable)
+                {
+                    if(!AssetStream::IsSeekable(compressed))
+                        return false;
+                    AssetStream stream(compressed, pool);
+                    return stream.GetLength() == content.size()
+                           && stream.Read(content.data(), content.size()) == content.size()
+                           && content == asset.content;
+                }
+
+                if(ZSTD_getFrameContentSize(compressed.data(), compressed.size()) != content.size())
+                    return false;
+                auto   lease  = pool->Acquire();
+                size_t result = ZSTD_decompress_usingDict(lease.Get(),
+                    content.data(),
+                    content.size(),
+                    compressed.data(),
+                    compressed.size(),
+                    dictionary.data(),
+                    dictionary.size());
+                return !ZSTD_isError(result) && result == content.size() && content == asset.content;
+            }
+            catch(const std::exception&)
+            {
+                return false;
+            }
+        }
+
+    public:
+        explicit CompressCache(const fs::path& directory) : directory(directory)
+        {
+            fs::create_directories(directory / "dictionaries");
+        }
+
+        // dictionaryHash为所用字典内容的哈希，不用字典时为0
+        static String GetKey(const Asset& asset, uint64_t dictionaryHash)
+        {
+            uint64_t params[] = { asset.hash,
+                asset.content.size(),
+                static_cast<uint64_t>(asset.level),
+                asset.seekable,
+                dictionaryHash,
+                ZSTD_versionNumber() };
+            char     key[17];
+            std::snprintf(key,
+                sizeof(key),
+                "%016llx",
+                static_cast<unsigned long long>(AssetIndex::Hash(
+                    AsText(BinaryData(reinterpret_cast<const uint8_t*>(params), sizeof(params))))));
+            return key;
+        }
+
+        // 可在多个线程同时调用
+        bool Load(const String& key, const Asset& asset, BinaryData dictionary, std::vector<uint8_t>& compressed)
+        {
+            fs::path path = directory / (key + ".zst");
+            {
+                std::lock_guard lock(mutex);
+                used.insert(key + ".zst");
+            }
+            std::error_code error;
+            if(fs::exists(path, error))
+            {
+                compressed = ReadFile(path);
+                if(Verify(asset, compressed, dictionary))
+                {
+                    hits++;
+                    return true;
+                }
+            }
+            misses++;
+            return false;
+        }
+
+        void Store(const String& key, BinaryData compressed)
+        {
+            WriteFile(directory / (key + ".zst"), compressed);
+        }
+
+        std::vector<uint8_t> LoadDictionary(const String& type)
+        {
+            fs::path        path = directory / "dictionaries" / (type + ".dict");
+            std::error_code error;
+            return fs::exists(path, error) ? ReadFile(path) : std::vector<uint8_t>();
+        }
+
+        void StoreDictionary(const String& type, BinaryData dictionary)
+        {
+            WriteFile(directory / "dictionaries" / (type + ".dict"), dictionary);
+        }
+
+        // 返回删除的文件数；只删除压缩结果，其他构建正在写入的临时文件不受影响
+        size_t Prune()
+        {
+            size_t removed = 0;
+            for(auto& entry : fs::directory_iterator(directory))
+            {
+                if(entry.is_regular_file() && entry.path().extension() == ".zst"
+                    && !used.contains(entry.path().filename().string()))
+                {
+                    fs::remove(entry.path());
+                    removed++;
+                }
+            }
+            return removed;
+        }
+
+        size_t GetHits() const
+        {
+            return hits;
+        }
+
+        size_t GetMisses() const
+        {
+            return misses;
+        }
+    };
+
+    // 在线程池上执行jobs，全部完成后重新抛出其中第一个异常
+    void RunAll(WorkerPool& pool, const std::vector<std::function<void()>>& jobs)
+    {
+        std::latch         done(jobs.size());
+        std::mutex         mutex;
+        std::exception_ptr error;
+        for(auto& job : jobs)
+        {
+            pool.Submit(
+                [&]
+                {
+                    try
+                    {
+                        job();
+                    }
+                    catch(...)
+                    {
+                        std::lock_guard lock(mutex);
+                        if(!error)
+                            error = std::current_exception();
+                    }
+                    done.count_down();
+                });
+        }
+        done.wait();
+        if(error)
+            std::rethrow_exception(error);
+    }
+
+    std::vector<Asset> CollectAssets(const Options& options, WorkerPool& pool)
+    {
+        fs::path           root   = options.input;
+        fs::path           output = fs::weakly_canonical(options.output);
+        fs::path           cache  = options.cache.empty() ? fs::path() : fs::weakly_canonical(options.cache);
+        std::vector<Asset> assets;
+        for(auto it = fs::recursive_directory_iterator(root); it != fs::recursive_directory_iterator(); ++it)
+        {
+            auto& entry = *it;
+            auto  path  = fs::weakly_canonical(entry.path());
+            if(!cache.empty() && path == cache)
+            {
+                it.disable_recursion_pending();
+                continue;
+            }
+            if(!entry.is_regular_file() || path == output || IsTempOf(path, output))
+                continue;
+            Asset asset;
+            asset.uri  = options.prefix + entry.path().lexically_relative(root).generic_string();
+            asset.type = GetType(entry.path());
+            asset.path = entry.path();
+            assets.push_back(std::move(asset));
+        }
+        // 按uri排序，使同样的输入得到同样的资源包
+        std::sort(assets.begin(), assets.end(), [](auto& a, auto& b) { return a.uri < b.uri; });
+
+        std::vector<std::function<void()>> jobs;
+        for(auto& asset : assets)
+        {
+            jobs.push_back(
+                [&asset]
+                {
+                    asset.content = ReadFile(asset.path);
+                    asset.hash    = AssetIndex::Hash(AsText(asset.content));
+                });
+        }
+        RunAll(pool, jobs);
+        return assets;
+    }
+
+    // 内容相同的资源指向第一个
+    void Deduplicate(std::vector<Asset>& assets)
+    {
+        std::unordered_map<uint64_t, std::vector<size_t>> byHash;
+        for(size_t i = 0; i < assets.size(); i++)
+        {
+            auto& candidates = byHash[assets[i].hash];
+            for(size_t j : candidates)
+            {
+                if(assets[j].content == assets[i].content)
+                {
+                    assets[i].source = j;
+                    break;
+                }
+            }
+            if(assets[i].source == SIZE_MAX)
+                candidates.push_back(i);
+        }
+    }
+
+    // 返回各字典的内容，供缓存计算键和校验
+    std::map<String, std::vector<uint8_t>> TrainDictionaries(
+        const Options& options, std::vector<Asset>& assets, AssetPackWriter& writer, CompressCache* cache)
+    {
+        std::map<String, std::vector<uint8_t>> dictionaries;
+        for(auto& type : options.dictionaries)
+        {
+            auto usesDictionary = [&type](const Asset& asset)
+            {
+                return asset.type == type && !asset.seekable && !asset.stored
+                       && asset.content.size() <= DICTIONARYMAXSIZE;
+            };
+
+            // 沿用缓存中的字典，否则只要有一个样本变化，用字典压缩的所有文件都要重新压缩
+            std::vector<uint8_t> dictionary;
+            if(cache && !options.retrain)
+                dictionary = cache->LoadDictionary(type);
+            if(dictionary.empty())
+            {
+                std::vector<BinaryData> samples;
+                for(auto& asset : assets)
+                {
+                    if(usesDictionary(asset) && asset.source == SIZE_MAX)
+                        samples.push_back(asset.content);
+                }
+                dictionary = AssetPackWriter::TrainDictionary(samples);
+                if(dictionary.empty())
+                {
+                    std::cerr << "warning: not enough ." << type << " samples to train a dictionary" << std::endl;
+                    continue;
+                }
+                if(cache)
+                    cache->StoreDictionary(type, dictionary);
+            }
+
+            dictionaries[type] = dictionary;
+            writer.AddDictionary(type, std::move(dictionary));
+            for(auto& asset : assets)
+            {
+                if(usesDictionary(asset))
+                    asset.dictionary = type;
+            }
+        }
+        return dictionaries;
+    }
+
+    void CompressAssets(std::vector<Asset>&           assets,
+        AssetPackWriter&                              writer,
+        const std::map<String, std::vector<uint8_t>>& dictionaries,
+        CompressCache*                                cache,
+        WorkerPool&                                   pool)
+    {
+        // 大文件先开始，减少最后只剩一个线程在压缩的时间
+        std::vector<Asset*> order;
+        for(auto& asset : assets)
+        {
+            if(asset.source == SIZE_MAX && !asset.stored)
+                order.push_back(&asset);
+        }
+        std::sort(order.begin(), order.end(), [](auto a, auto b) { return a->content.size() > b->content.size(); });
+
+        std::map<String, uint64_t> dictionaryHashes;
+        for(auto& [type, dictionary] : dictionaries)
+        {
+            dictionaryHashes[type] = AssetIndex::Hash(AsText(dictionary));
+        }
+
+        std::vector<std::function<void()>> jobs;
+        for(auto asset : order)
+        {
+            const ZSTD_CDict_s* prepared = nullptr;
+            BinaryData          dictionary;
+            String              key;
+            if(!asset->dictionary.empty())
+            {
+                prepared   = writer.GetCompressDictionary(asset->dictionary, asset->level);
+                dictionary = dictionaries.at(asset->dictionary);
+            }
+            if(cache)
+            {
+                uint64_t dictionaryHash = asset->dictionary.empty() ? 0 : dictionaryHashes[asset->dictionary];
+                key                     = CompressCache::GetKey(*asset, dictionaryHash);
+            }
+            jobs.push_back(
+                [asset, prepared, dictionary, cache, key]
+                {
+                    if(cache && cache->Load(key, *asset, dictionary, asset->compressed))
+                        return;
+                    if(asset->seekable)
+                        asset->compressed = AssetPackWriter::CompressSeekable(asset->content, asset->level);
+                    else
+                        asset->compressed = AssetPackWriter::Compress(asset->content, asset->level, prepared);
+                    if(cache)
+                        cache->Store(key, asset->compressed);
+                });
+        }
+        RunAll(pool, jobs);
+    }
+
+    void PrintReport(const std::vector<Asset>& assets, size_t packSize, double seconds)
+    {
+        std::map<String, TypeReport> types;
+        TypeReport                   total;
+        for(auto& asset : assets)
+        {
+            for(auto report : { &types[asset.type.empty() ? "(none)" : asset.type], &total })
+            {
+                report->files++;
+                report->original += asset.content.size();
+                if(asset.source == SIZE_MAX)
+                    report->packed += asset.GetPackedSize();
+                else
+                    report->duplicates++;
+            }
+        }
+
+        auto print = [](const String& name, const TypeReport& report)
+        {
+            std::printf("%-12s %8zu %10zu %14zu %14zu %8.2f%%\n",
+                name.c_str(),
+                report.files,
+                report.duplicates,
+                report.original,
+                report.packed,
+                report.original ? 100.0 * report.packed / report.original : 0.0);
+        };
+        std::printf("%-12s %8s %10s %14s %14s %9s\n", "type", "files", "duplicates", "original", "packed", "ratio");
+        for(auto& [type, report] : types)
+        {
+            print(type, report);
+        }
+        print("total", total);
+        std::printf("\npack %zu bytes (%zu bytes of dictionaries and index) in %.3fs\n",
+            packSize,
+            packSize - total.packed,
+            seconds);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: ezi-pack <directory> -o <output> [--prefix <uri prefix>] [--config <file>] "
+                     "[--jobs <count>] [--level <ext>=<level>]... [--dict <ext>]... [--seekable <bytes>] "
+                     "[--json-manifest] [--cache <directory>] [--retrain] [--prune-cache]"
+                  << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        auto started = Clock::now();
+        if(options.jsonManifest)
+        {
+            if(!options.dictionaries.empty())
+                std::cerr << "warning: --dict is ignored with --json-manifest" << std::endl;
+            options.dictionaries.clear();
+            options.seekableBytes = 0;
+        }
+
+        Json config;
+        if(options.config.empty())
+        {
+            std::cerr << "warning: no --config given; release builds read " << CONFIGURI
+                      << " from the pack and will fail to start with this pack" << std::endl;
+        }
+        else
+        {
+            auto content = ReadFile(options.config);
+            config       = Json::parse(content.begin(), content.end());
+            if(options.prefix.empty())
+                options.prefix = "https://" + at<String>(config, "application.package", "com.ezi.app") + "/";
+        }
+
+        WorkerPool pool(options.jobs ? options.jobs : std::max(1u, std::thread::hardware_concurrency()));
+        auto       assets = CollectAssets(options, pool);
+        if(!options.config.empty())
+        {
+            Asset  asset;
+            String text   = config.dump();
+            asset.uri     = CONFIGURI;
+            asset.type    = "manifest";
+            asset.content = std::vector<uint8_t>(text.begin(), text.end());
+            asset.hash    = AssetIndex::Hash(text);
+            assets.push_back(std::move(asset));
+        }
+
+        Deduplicate(assets);
+        for(auto& asset : assets)
+        {
+            asset.level    = GetLevel(options, asset.type);
+            asset.stored   = IsStored(options, asset.type);
+            asset.seekable = !asset.stored && options.seekableBytes && asset.content.size() >= options.seekableBytes
+                             && IsSeekableType(asset.type);
+        }
+
+        std::unique_ptr<CompressCache> cache;
+        if(!options.cache.empty())
+            cache = std::make_unique<CompressCache>(options.cache);
+
+        AssetPackWriter writer;
+        auto            dictionaries = TrainDictionaries(options, assets, writer, cache.get());
+        CompressAssets(assets, writer, dictionaries, cache.get(), pool);
+
+        for(auto& asset : assets)
+        {
+            if(asset.source != SIZE_MAX)
+                writer.AddAlias(asset.uri, assets[asset.source].uri);
+            else if(asset.stored)
+                writer.AddStored(asset.uri, asset.content);
+            else if(asset.seekable)
+                writer.AddCompressedSeekable(asset.uri, asset.compressed);
+            else
+                writer.AddCompressed(asset.uri, asset.compressed, asset.dictionary);
+        }
+        auto pack = writer.Finish(options.jsonManifest ? IndexFormat::json : IndexFormat::binary);
+        WriteFile(options.output, pack);
+
+        PrintReport(assets, pack.size(), ElapsedNs(started) / 1e9);
+        if(cache)
+        {
+            std::printf("cache %zu hits, %zu misses", cache->GetHits(), cache->GetMisses());
+            if(options.pruneCache)
+                std::printf(", %zu pruned", cache->Prune());
+            std::printf("\n");
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// ezi-replay：按录制文件回放桥接调用，统计各函数的吞吐和延迟
+// 用法：ezi-replay <录制文件> [--speed <倍速>] [--repeat <次数>] [--stub]
+//   --speed 1 按原始节奏回放（默认），2 为两倍速，0 为不等待全速回放
+//   --stub  未注册的函数以回显代替，用于测量桥接本身的开销
+// 流式函数在回放线程上执行，数据块写出即丢弃，不受页面归还额度的节奏影响
+// 非Windows平台只注册了桥接的内置函数，窗口、托盘等扩展依赖Win32，录制中的扩展调用显示为missing，可用 --stub 代替
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "bridge.hpp"
+#include "recorder.hpp"
+
+using namespace ezi;
+
+namespace
+{
+    enum class Kind
+    {
+        unknown,
+        sync,
+        async,
+        stream,
+        missing
+    };
+
+    struct FunctionStats
+    {
+        Kind      kind   = Kind::unknown;
+        uint64_t  errors = 0;
+        Histogram latency;
+    };
+
+    struct Options
+    {
+        String path;
+        double speed  = 1.0;
+        int    repeat = 1;
+        bool   stub   = false;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            if(!std::strcmp(argv[i], "--speed") && i + 1 < argc)
+                options.speed = std::atof(argv[++i]);
+            else if(!std::strcmp(argv[i], "--repeat") && i + 1 < argc)
+                options.repeat = std::atoi(argv[++i]);
+            else if(!std::strcmp(argv[i], "--stub"))
+                options.stub = true;
+            else if(argv[i][0] != '-' && options.path.empty())
+                options.path = argv[i];
+            else
+                return false;
+        }
+        return !options.path.empty() && options.speed >= 0 && options.repeat > 0;
+    }
+
+    Kind Classify(Bridge& bridge, const String& func, bool stub)
+    {
+        try
+        {
+            bridge.GetFunctionId(func);
+        }
+        catch(const BridgeError&)
+        {
+            if(!stub)
+                return Kind::missing;
+            bridge.Register(func, [](Object args) { return args; });
+            return Kind::sync;
+        }
+
+        if(bridge.IsStream(func))
+            return Kind::stream;
+        return bridge.IsAsync(func) ? Kind::async : Kind::sync;
+    }
+
+    // 返回是否成功
+    bool Replay(Bridge& bridge, const RecordedCall& call, Kind kind)
+    {
+        CallContext context;
+        if(!call.sender.empty())
+            context.sender = reinterpret_cast<WinId>(std::stoull(call.sender));
+
+        if(kind == Kind::sync || kind == Kind::stream)
+        {
+            try
+            {
+                if(kind == Kind::stream)
+                    bridge.CallStream(call.func, call.GetArgs());
+                else
+                    bridge.Call(call.func, call.GetArgs(), context);
+                return true;
+            }
+            catch(const std::exception&)
+            {
+                return false;
+            }
+        }
+
+        std::promise<Json> promise;
+        auto               future = promise.get_future();
+        bridge.CallAsync(call.func, call.GetArgs(), [&promise](Json result) { promise.set_value(std::move(result)); });
+        Json result = future.get();
+        return !(result.is_object() && result.contains("error"));
+    }
+
+    void PrintReport(const std::map<String, FunctionStats>& stats, uint64_t totalCalls, double seconds)
+    {
+        std::printf("%-32s %10s %8s %12s %10s %10s %10s %10s\n",
+            "function",
+            "calls",
+            "errors",
+            "calls/s",
+            "p50(us)",
+            "p90(us)",
+            "p99(us)",
+            "max(us)");
+        for(auto& [func, stat] : stats)
+        {
+            if(stat.kind == Kind::missing)
+            {
+                std::printf("%-32s %10s\n", func.c_str(), "missing");
+                continue;
+            }
+            Json summary = stat.latency.ToJson();
+            std::printf("%-32s %10llu %8llu %12.1f %10.1f %10.1f %10.1f %10.1f\n",
+                func.c_str(),
+                static_cast<unsigned long long>(stat.latency.GetCount()),
+                static_cast<unsigned long long>(stat.errors),
+                seconds > 0 ? stat.latency.GetCount() / seconds : 0.0,
+                summary["p50Us"].get<double>(),
+                summary["p90Us"].get<double>(),
+                summary["p99Us"].get<double>(),
+                summary["maxUs"].get<double>());
+        }
+        std::printf("\n%llu calls in %.3fs, %.1f calls/s\n",
+            static_cast<unsigned long long>(totalCalls),
+            seconds,
+            seconds > 0 ? totalCalls / seconds : 0.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: ezi-replay <recording> [--speed <factor>] [--repeat <count>] [--stub]" << std::endl;
+        return 2;
+    }
+
+    std::vector<RecordedCall> calls;
+    try
+    {
+        calls = Recorder::Load(options.path);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    auto&                           bridge = Bridge::GetInstance();
+    std::map<String, FunctionStats> stats;
+    for(auto& call : calls)
+    {
+        auto& stat = stats[call.func];
+        if(stat.kind == Kind::unknown)
+            stat.kind = Classify(bridge, call.func, options.stub);
+    }
+
+    // 页面的调用都在窗口线程上依次执行，回放同样在单线程上按顺序进行
+    uint64_t totalCalls = 0;
+    auto     started    = Clock::now();
+    for(int round = 0; round < options.repeat; round++)
+    {
+        auto roundStarted = Clock::now();
+        for(auto& call : calls)
+        {
+            auto& stat = stats[call.func];
+            if(stat.kind == Kind::missing)
+                continue;
+
+            if(options.speed > 0)
+            {
+                auto due = roundStarted
+                           + std::chrono::nanoseconds(static_cast<uint64_t>(call.offsetNs / options.speed));
+                std::this_thread::sleep_until(due);
+            }
+
+            auto callStarted = Clock::now();
+            if(!Replay(bridge, call, stat.kind))
+                stat.errors++;
+            stat.latency.Record(ElapsedNs(callStarted));
+            totalCalls++;
+        }
+    }
+
+    PrintReport(stats, totalCalls, ElapsedNs(started) / 1e9);
+    return 0;
+}